@@ -1,5 +1,6 @@
 #include <QtCore>
 #include <QtCouchDB>
+#include "loadgenerator.h"
 #include <cstdlib>
 #include <iostream>
 
@@ -12,8 +13,17 @@ static bool parseOptions(QCommandLineParser &cmdLine)
         {{"db", "database"}, "CouchDB Database", "database", ""},
         {{"dd", "design", "design-document"}, "CouchDB Design Document", "design-document", ""},
         {{"v", "view"}, "CouchDB View", "view", ""},
+        {"mix", "Benchmark operation mix (default: get:70,create:10,update:10,delete:5,bulk:5)", "mix", "get:70,create:10,update:10,delete:5,bulk:5"},
+        {{"c", "concurrency"}, "Benchmark requests in flight (default: 8)", "concurrency", "8"},
+        {{"r", "rate"}, "Benchmark requests per second, 0 for as fast as possible (default: 0)", "rate", "0"},
+        {{"t", "duration"}, "Benchmark duration in seconds (default: 10)", "duration", "10"},
+        {{"i", "interval"}, "Benchmark report interval in seconds, 0 to disable (default: 1)", "interval", "1"},
+        {"documents", "Benchmark documents to create up front (default: 100)", "documents", "100"},
+        {"document-size", "Benchmark document size in bytes (default: 256)", "document-size", "256"},
+        {"bulk-size", "Benchmark documents per bulk insert (default: 100)", "bulk-size", "100"},
+        {"limit", "Benchmark rows per view query (default: 10)", "limit", "10"},
     });
-    cmdLine.addPositionalArgument("command", "CouchDB command (available: list-dbs, list-designs, list-views, list-rows)", "command");
+    cmdLine.addPositionalArgument("command", "CouchDB command (available: list-dbs, list-designs, list-views, list-rows, bench)", "command");
     if (!cmdLine.parse(QCoreApplication::arguments()))
         return false;
     if (cmdLine.isSet("help"))
@@ -64,8 +74,45 @@ static CouchView *createView(const QString &name, CouchDesignDocument *designDoc
     return view;
 }
 
+static int runBenchmark(const QCommandLineParser &cmdLine)
+{
+    LoadGenerator::Options options;
+    options.concurrency = qMax(1, cmdLine.value("concurrency").toInt());
+    options.rate = qMax(0, cmdLine.value("rate").toInt());
+    options.duration = qMax(1, cmdLine.value("duration").toInt());
+    options.interval = qMax(0, cmdLine.value("interval").toInt());
+    options.documents = qMax(0, cmdLine.value("documents").toInt());
+    options.documentSize = qMax(0, cmdLine.value("document-size").toInt());
+    options.bulkSize = qMax(1, cmdLine.value("bulk-size").toInt());
+    options.limit = qMax(1, cmdLine.value("limit").toInt());
+    if (!LoadGenerator::parseMix(cmdLine.value("mix"), &options.mix)) {
+        std::cerr << qPrintable(QCoreApplication::applicationName()) << ": Invalid operation mix: '" << qPrintable(cmdLine.value("mix")) << "'." << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (options.mix.value(LoadGenerator::View) > 0 && (cmdLine.value("design-document").isEmpty() || cmdLine.value("view").isEmpty())) {
+        std::cerr << qPrintable(QCoreApplication::applicationName()) << ": View queries require a design document and a view." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // unlike the other commands, errors are counted rather than fatal
+    CouchClient client(QUrl(cmdLine.value("url")));
+    QString name = cmdLine.value("database");
+    CouchDatabase database(name.isEmpty() ? QStringLiteral("bench") : name, &client);
+    CouchDesignDocument designDocument(cmdLine.value("design-document"), &database);
+    CouchView view(cmdLine.value("view"), &designDocument);
+
+    LoadGenerator generator(&database, &view, options);
+    QObject::connect(&generator, &LoadGenerator::finished, qApp, &QCoreApplication::quit, Qt::QueuedConnection);
+    generator.start();
+
+    return QCoreApplication::exec();
+}
+
 static int runApp(const QCommandLineParser &cmdLine)
 {
+    if (cmdLine.positionalArguments().value(0) == "bench")
+        return runBenchmark(cmdLine);
+
     QScopedPointer<CouchClient> client(createClient(QUrl(cmdLine.value("url"))));
     QScopedPointer<CouchDatabase> database(createDatabase(cmdLine.value("database"), client.data()));
     QScopedPointer<CouchDesignDocument> designDocument(createDesignDocument(cmdLine.value("design-document"), database.data()));
@@ -1,8 +1,12 @@
 TEMPLATE = app
 QT += couchdb
 
+HEADERS += \
+    loadgenerator.h
+
 SOURCES += \
-    cli.cpp
+    cli.cpp \
+    loadgenerator.cpp
 
 target.path = $$[QT_INSTALL_EXAMPLES]/cli
 INSTALLS += target
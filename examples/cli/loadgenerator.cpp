@@ -0,0 +1,280 @@
+#include "loadgenerator.h"
+#include <iostream>
+
+static const char *const OperationNames[] = { "get", "create", "update", "delete", "bulk", "view" };
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+static const Qt::SplitBehavior SkipEmptyParts = Qt::SkipEmptyParts;
+#else
+static const QString::SplitBehavior SkipEmptyParts = QString::SkipEmptyParts;
+#endif
+
+static void track(CouchResponse *response, QObject *context, std::function<void(bool)> done)
+{
+    if (!response) {
+        QMetaObject::invokeMethod(context, [=]() { done(true); }, Qt::QueuedConnection);
+        return;
+    }
+    QObject::connect(response, &CouchResponse::received, context, [=]() { done(false); });
+    QObject::connect(response, &CouchResponse::errorOccurred, context, [=]() { done(true); });
+}
+
+static qint64 percentile(const QVector<qint64> &sorted, qreal quantile)
+{
+    if (sorted.isEmpty())
+        return 0;
+    return sorted.at(qMin(sorted.count() - 1, int(quantile * sorted.count())));
+}
+
+LoadGenerator::LoadGenerator(CouchDatabase *database, CouchView *view, const Options &options, QObject *parent)
+    : QObject(parent), m_database(database), m_view(view), m_options(options)
+{
+    // the documents known to exist, with their latest revisions
+    connect(database, &CouchDatabase::documentCreated, this, [=](const CouchDocument &document) {
+        if (!document.id().isEmpty())
+            m_documents += document;
+    });
+    connect(database, &CouchDatabase::documentUpdated, this, [=](const CouchDocument &document) {
+        if (!document.id().isEmpty())
+            m_documents += document;
+    });
+
+    connect(&m_rateTimer, &QTimer::timeout, this, &LoadGenerator::tick);
+    connect(&m_reportTimer, &QTimer::timeout, this, [=]() {
+        qint64 now = m_clock.elapsed();
+        report(QStringLiteral("%1s").arg(now / 1000.0, 0, 'f', 1), m_interval, (now - m_lastReport) / 1000.0);
+        for (Stats &stats : m_interval)
+            stats = Stats();
+        m_lastReport = now;
+    });
+}
+
+bool LoadGenerator::parseMix(const QString &mix, QMap<Operation, int> *result)
+{
+    result->clear();
+    for (const QString &entry : mix.split(QLatin1Char(','), SkipEmptyParts)) {
+        const QString name = entry.section(QLatin1Char(':'), 0, 0).trimmed();
+        bool ok = false;
+        int weight = entry.section(QLatin1Char(':'), 1, 1).toInt(&ok);
+        int operation = std::find(std::begin(OperationNames), std::end(OperationNames), name) - std::begin(OperationNames);
+        if (!ok || weight < 0 || operation >= OperationCount)
+            return false;
+        result->insert(static_cast<Operation>(operation), weight);
+    }
+    return !result->isEmpty();
+}
+
+void LoadGenerator::start()
+{
+    CouchClient *client = m_database->client();
+    client->setMaxActiveRequests(m_options.concurrency);
+
+    // the database may exist already, in which case the request fails harmlessly
+    track(client->createDatabase(m_database->name()), this, [=](bool) { seed(); });
+}
+
+void LoadGenerator::seed()
+{
+    if (m_options.documents <= 0) {
+        run();
+        return;
+    }
+
+    std::cout << "Seeding " << m_options.documents << " documents..." << std::endl;
+    m_pending = m_options.documents;
+    for (int i = 0; i < m_options.documents; ++i) {
+        track(m_database->createDocument(createDocument()), this, [=](bool) {
+            if (--m_pending == 0)
+                run();
+        });
+    }
+}
+
+void LoadGenerator::run()
+{
+    std::cout << "Running for " << m_options.duration << "s at ";
+    if (m_options.rate > 0)
+        std::cout << m_options.rate << " requests/s";
+    else
+        std::cout << "concurrency " << m_options.concurrency;
+    std::cout << "..." << std::endl;
+
+    m_running = true;
+    m_clock.start();
+    if (m_options.interval > 0)
+        m_reportTimer.start(m_options.interval * 1000);
+    QTimer::singleShot(m_options.duration * 1000, this, &LoadGenerator::stop);
+
+    if (m_options.rate > 0) {
+        // open loop: requests are issued on schedule whether or not earlier
+        // ones have completed, so queuing delays show up in the latencies
+        m_rateTimer.setTimerType(Qt::PreciseTimer);
+        m_rateTimer.start(1);
+    } else {
+        // closed loop: a fixed number of requests in flight at all times
+        for (int i = 0; i < m_options.concurrency; ++i)
+            issue();
+    }
+}
+
+void LoadGenerator::tick()
+{
+    qint64 due = m_clock.elapsed() * m_options.rate / 1000;
+    while (m_running && m_issued < due)
+        issue();
+}
+
+void LoadGenerator::stop()
+{
+    m_running = false;
+    m_rateTimer.stop();
+    m_reportTimer.stop();
+
+    auto finish = [=]() {
+        std::cout << std::endl << "Summary" << std::endl;
+        report(QStringLiteral("total"), m_total, m_clock.elapsed() / 1000.0);
+        emit finished();
+    };
+
+    if (m_pending == 0) {
+        finish();
+        return;
+    }
+
+    // let the requests in flight complete, but do not wait forever
+    std::cout << "Waiting for " << m_pending << " pending requests..." << std::endl;
+    QTimer *drain = new QTimer(this);
+    connect(drain, &QTimer::timeout, this, [=]() {
+        if (m_pending > 0 && m_clock.elapsed() < (m_options.duration + 30) * 1000ll)
+            return;
+        drain->deleteLater();
+        finish();
+    });
+    drain->start(10);
+}
+
+void LoadGenerator::issue()
+{
+    issue(pick());
+}
+
+void LoadGenerator::issue(Operation operation)
+{
+    if (m_documents.isEmpty() && (operation == Get || operation == Update || operation == Delete))
+        operation = Create;
+
+    const qint64 startTime = m_clock.nsecsElapsed();
+    CouchResponse *response = nullptr;
+    switch (operation) {
+    case Get:
+        response = m_database->getDocument(m_documents.at(QRandomGenerator::global()->bounded(m_documents.count())));
+        break;
+    case Create:
+        response = m_database->createDocument(createDocument());
+        break;
+    case Update: {
+        CouchDocument document = take();
+        response = m_database->updateDocument(document.withContent(createDocument().content()));
+        break;
+    }
+    case Delete:
+        response = m_database->deleteDocument(take());
+        break;
+    case Bulk: {
+        QList<CouchDocument> documents;
+        for (int i = 0; i < m_options.bulkSize; ++i)
+            documents += createDocument();
+        response = m_database->insertDocuments(documents);
+        break;
+    }
+    case View: {
+        CouchQuery query;
+        query.setLimit(m_options.limit);
+        response = m_view->queryRows(query);
+        break;
+    }
+    default:
+        Q_UNREACHABLE();
+    }
+
+    ++m_issued;
+    ++m_pending;
+    track(response, this, [=](bool failed) { complete(operation, startTime, failed); });
+}
+
+void LoadGenerator::complete(Operation operation, qint64 startTime, bool failed)
+{
+    --m_pending;
+
+    qint64 latency = (m_clock.nsecsElapsed() - startTime) / 1000;
+    for (Stats *stats : {&m_interval[operation], &m_total[operation]}) {
+        if (failed)
+            ++stats->errors;
+        else
+            stats->latencies += latency;
+    }
+
+    if (m_running && m_options.rate <= 0)
+        issue();
+}
+
+void LoadGenerator::report(const QString &label, const Stats *stats, qreal seconds) const
+{
+    auto ms = [](qint64 us) { return QString::number(us / 1000.0, 'f', 2); };
+
+    for (int operation = 0; operation < OperationCount; ++operation) {
+        const Stats &s = stats[operation];
+        if (s.latencies.isEmpty() && s.errors == 0)
+            continue;
+
+        QVector<qint64> sorted = s.latencies;
+        std::sort(sorted.begin(), sorted.end());
+        const qreal throughput = seconds > 0 ? sorted.count() / seconds : 0;
+        std::cout << qPrintable(QStringLiteral("%1 %2 %3 req/s  p50 %4 ms  p99 %5 ms  p999 %6 ms  errors %7")
+                                    .arg(label, 6)
+                                    .arg(QString::fromLatin1(OperationNames[operation]), -6)
+                                    .arg(throughput, 9, 'f', 1)
+                                    .arg(ms(percentile(sorted, 0.5)), 7)
+                                    .arg(ms(percentile(sorted, 0.99)), 7)
+                                    .arg(ms(percentile(sorted, 0.999)), 7)
+                                    .arg(s.errors))
+                  << std::endl;
+    }
+}
+
+LoadGenerator::Operation LoadGenerator::pick() const
+{
+    int total = 0;
+    for (int weight : m_options.mix)
+        total += weight;
+
+    int value = QRandomGenerator::global()->bounded(qMax(1, total));
+    for (auto it = m_options.mix.cbegin(); it != m_options.mix.cend(); ++it) {
+        if (value < it.value())
+            return it.key();
+        value -= it.value();
+    }
+    return Get;
+}
+
+// checks a document out of the pool, so that concurrent updates and deletes
+// do not conflict over the same revision
+CouchDocument LoadGenerator::take()
+{
+    int index = QRandomGenerator::global()->bounded(m_documents.count());
+    CouchDocument document = m_documents.at(index);
+    m_documents[index] = m_documents.last();
+    m_documents.removeLast();
+    return document;
+}
+
+CouchDocument LoadGenerator::createDocument()
+{
+    int index = m_counter++;
+    QByteArray content = R"({"type":"bench","index":)" + QByteArray::number(index) + R"(,"text":")";
+    content += QByteArray(qMax(0, m_options.documentSize - content.size() - 2), 'x');
+    content += "\"}";
+
+    QString id = QStringLiteral("bench-%1-%2").arg(QCoreApplication::applicationPid()).arg(index);
+    return CouchDocument(id).withContent(content);
+}
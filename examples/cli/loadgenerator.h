@@ -0,0 +1,72 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QtCore>
+#include <QtCouchDB>
+
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Operation { Get, Create, Update, Delete, Bulk, View, OperationCount };
+
+    struct Options
+    {
+        QMap<Operation, int> mix;
+        int concurrency = 8;
+        int rate = 0;
+        int duration = 10;
+        int interval = 1;
+        int documents = 100;
+        int bulkSize = 100;
+        int documentSize = 256;
+        int limit = 10;
+    };
+
+    LoadGenerator(CouchDatabase *database, CouchView *view, const Options &options, QObject *parent = nullptr);
+
+    static bool parseMix(const QString &mix, QMap<Operation, int> *result);
+
+    void start();
+
+signals:
+    void finished();
+
+private:
+    struct Stats
+    {
+        int errors = 0;
+        QVector<qint64> latencies;
+    };
+
+    void seed();
+    void run();
+    void tick();
+    void stop();
+    void issue();
+    void issue(Operation operation);
+    void complete(Operation operation, qint64 startTime, bool failed);
+    void report(const QString &label, const Stats *stats, qreal seconds) const;
+
+    Operation pick() const;
+    CouchDocument take();
+    CouchDocument createDocument();
+
+    CouchDatabase *m_database = nullptr;
+    CouchView *m_view = nullptr;
+    Options m_options;
+    bool m_running = false;
+    int m_pending = 0;
+    int m_counter = 0;
+    qint64 m_issued = 0;
+    qint64 m_lastReport = 0;
+    QElapsedTimer m_clock;
+    QTimer m_rateTimer;
+    QTimer m_reportTimer;
+    QVector<CouchDocument> m_documents;
+    Stats m_interval[OperationCount];
+    Stats m_total[OperationCount];
+};
+
+#endif // LOADGENERATOR_H
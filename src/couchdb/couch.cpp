@@ -1,4 +1,7 @@
 #include "couch.h"
+#include "couchdecoder_p.h"
+#include "couchdocument_p.h"
+#include "couchjson_p.h"
 #include "couchurl_p.h"
 
 #include <QtCore/qjsonarray.h>
@@ -172,6 +175,7 @@ CouchRequest Couch::getDocument(const QUrl &databaseUrl, const CouchDocument &do
 {
     CouchRequest request(CouchRequest::Get);
     request.setUrl(CouchUrl::resolve(databaseUrl, document.id(), document.revision()));
+    request.setPriority(CouchRequest::Interactive);
     return request;
 }
 
@@ -190,19 +194,66 @@ CouchRequest Couch::deleteDocument(const QUrl &databaseUrl, const CouchDocument
     return request;
 }
 
+// writes {"docs":[...]} by splicing the content of the documents as is,
+// instead of going through a QJsonObject and a QJsonArray of each of them
 static QByteArray fromDocumentList(const QList<CouchDocument> &documents, bool deleted = false)
 {
-    QJsonArray docs;
+    QList<QByteArray> contents;
+    contents.reserve(documents.count());
+    int size = 16;
     for (const CouchDocument &document : documents) {
-        QJsonObject doc = document.toJson();
-        if (deleted)
-            doc.insert(QStringLiteral("_deleted"), true);
-        docs += document.toJson();
+        // the documents of a listing are spliced from the response without decoding them
+        contents += CouchDocumentPrivate::rawContent(document);
+        size += contents.last().size() + document.id().size() + document.revision().size() + 48;
     }
 
-    QJsonObject json;
-    json.insert(QStringLiteral("docs"), docs);
-    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+    QByteArray json;
+    json.reserve(size);
+    json += "{\"docs\":[";
+    for (int i = 0; i < documents.count(); ++i) {
+        const CouchDocument &document = documents.at(i);
+        const QString id = document.id();
+        const QString revision = document.revision();
+
+        if (i > 0)
+            json += ',';
+        json += '{';
+        bool first = true;
+        auto appendKey = [&](const QByteArray &key) {
+            if (!first)
+                json += ',';
+            first = false;
+            json += '"';
+            json += key;
+            json += "\":";
+        };
+
+        if (!id.isEmpty()) {
+            appendKey("_id");
+            CouchJson::appendString(json, id);
+        }
+        if (!revision.isEmpty()) {
+            appendKey("_rev");
+            CouchJson::appendString(json, revision);
+        }
+        if (deleted) {
+            appendKey("_deleted");
+            json += "true";
+        }
+
+        // the members written above take precedence over those in the content
+        const QByteArray &content = contents.at(i);
+        const char *data = content.constData();
+        CouchJson::forEachMember(data, CouchJsonSpan(0, content.size()), [&](const QByteArray &key, const CouchJsonSpan &value) {
+            if ((key == "_id" && !id.isEmpty()) || (key == "_rev" && !revision.isEmpty()) || (key == "_deleted" && deleted))
+                return;
+            appendKey(key);
+            json.append(data + value.start, value.length);
+        });
+        json += '}';
+    }
+    json += "]}";
+    return json;
 }
 
 CouchRequest Couch::insertDocuments(const QUrl &databaseUrl, const QList<CouchDocument> &documents)
@@ -210,6 +261,7 @@ CouchRequest Couch::insertDocuments(const QUrl &databaseUrl, const QList<CouchDo
     CouchRequest request(CouchRequest::Post);
     request.setUrl(databaseUrl);
     request.setBody(fromDocumentList(documents));
+    request.setPriority(CouchRequest::Bulk);
     return request;
 }
 
@@ -218,6 +270,7 @@ CouchRequest Couch::updateDocuments(const QUrl &databaseUrl, const QList<CouchDo
     CouchRequest request(CouchRequest::Post);
     request.setUrl(databaseUrl);
     request.setBody(fromDocumentList(documents));
+    request.setPriority(CouchRequest::Bulk);
     return request;
 }
 
@@ -226,6 +279,7 @@ CouchRequest Couch::deleteDocuments(const QUrl &databaseUrl, const QList<CouchDo
     CouchRequest request(CouchRequest::Post);
     request.setUrl(databaseUrl);
     request.setBody(fromDocumentList(documents, true));
+    request.setPriority(CouchRequest::Bulk);
     return request;
 }
 
@@ -282,15 +336,21 @@ CouchDocument Couch::toDocument(const QByteArray &response)
 
 QList<CouchDocument> Couch::toDocumentList(const QByteArray &response)
 {
-    QJsonDocument json = QJsonDocument::fromJson(response);
-    QJsonArray rows = json.object().value(QStringLiteral("rows")).toArray();
+    // the rows refer to the response, and decode their fields on demand
+    const QVector<CouchRowSpan> spans = CouchDecoder::rowSpans(response);
 
     QList<CouchDocument> docs;
-    for (const QJsonValue &value : qAsConst(rows))
-        docs += CouchDocument::fromJson(value.toObject());
+    docs.reserve(spans.count());
+    for (const CouchRowSpan &span : spans)
+        docs += CouchDocumentPrivate::fromRow(response, span.start, span.length);
     return docs;
 }
 
+CouchRowSet Couch::toRowSet(const QByteArray &response)
+{
+    return CouchRowSet::fromJson(response);
+}
+
 QStringList Couch::toViews(const QByteArray &response)
 {
     QJsonDocument json = QJsonDocument::fromJson(response);
@@ -5,6 +5,7 @@
 #include <QtCouchDB/couchdocument.h>
 #include <QtCouchDB/couchquery.h>
 #include <QtCouchDB/couchrequest.h>
+#include <QtCouchDB/couchrowset.h>
 #include <QtCore/qobject.h>
 
 class COUCHDB_EXPORT Couch : public QObject
@@ -78,6 +79,7 @@ public:
 
     static CouchDocument toDocument(const QByteArray &response);
     static QList<CouchDocument> toDocumentList(const QByteArray &response);
+    static CouchRowSet toRowSet(const QByteArray &response);
 
     static QStringList toViews(const QByteArray &response);
 };
@@ -0,0 +1,54 @@
+#include "couchawait.h"
+#include "couchclient_p.h"
+#include "couchresponse.h"
+#include "couchresponse_p.h"
+
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpointer.h>
+
+bool CouchAwait::watch(CouchResponse *response,
+                       const std::function<void(const QByteArray &)> &onReceived,
+                       const std::function<void(const CouchError &)> &onError)
+{
+    if (!response)
+        return false;
+
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    if (!r->client)
+        return false;
+
+    // resuming a coroutine from within the client's bookkeeping would let it
+    // send new requests in the middle of a reply, so it is deferred to the
+    // client's thread instead
+    QMutexLocker locker(&r->client->mutex);
+    QPointer<QObject> context(r->client->q_ptr);
+
+    // a response that has already been delivered resumes with its result
+    if (r->delivered) {
+        const QByteArray data = r->data;
+        const CouchError error = r->error;
+        if (r->failed)
+            QMetaObject::invokeMethod(context, [=]() { onError(error); }, Qt::QueuedConnection);
+        else
+            QMetaObject::invokeMethod(context, [=]() { onReceived(data); }, Qt::QueuedConnection);
+        return true;
+    }
+
+    // the handlers that are already in place, such as those of a future, are kept
+    const std::function<void(const QByteArray &)> previousReceived = r->onReceived;
+    const std::function<void(const CouchError &)> previousError = r->onError;
+    r->onReceived = [=](const QByteArray &data) {
+        if (previousReceived)
+            previousReceived(data);
+        if (context)
+            QMetaObject::invokeMethod(context, [=]() { onReceived(data); }, Qt::QueuedConnection);
+    };
+    r->onError = [=](const CouchError &error) {
+        if (previousError)
+            previousError(error);
+        if (context)
+            QMetaObject::invokeMethod(context, [=]() { onError(error); }, Qt::QueuedConnection);
+    };
+    return true;
+}
@@ -0,0 +1,119 @@
+#ifndef COUCHAWAIT_H
+#define COUCHAWAIT_H
+
+#include <QtCouchDB/couchglobal.h>
+#include <QtCouchDB/couch.h>
+#include <QtCouchDB/couchdocument.h>
+#include <QtCouchDB/coucherror.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstringlist.h>
+
+#include <functional>
+
+class CouchResponse;
+
+template <typename T>
+class CouchResult
+{
+public:
+    CouchResult() = default;
+    CouchResult(const T &value) : m_value(value), m_valid(true) { }
+    CouchResult(const CouchError &error) : m_error(error) { }
+
+    bool isValid() const { return m_valid; }
+    explicit operator bool() const { return m_valid; }
+
+    T value() const { return m_value; }
+    CouchError error() const { return m_error; }
+
+    const T &operator*() const { return m_value; }
+    const T *operator->() const { return &m_value; }
+
+private:
+    T m_value = T();
+    CouchError m_error;
+    bool m_valid = false;
+};
+
+namespace CouchAwait
+{
+    // calls back on the thread of the client, once the current signal emission has returned,
+    // or with the stored result if the response has already been delivered
+    COUCHDB_EXPORT bool watch(CouchResponse *response,
+                              const std::function<void(const QByteArray &)> &onReceived,
+                              const std::function<void(const CouchError &)> &onError);
+}
+
+#if defined(__cpp_impl_coroutine)
+#if __has_include(<coroutine>)
+#include <coroutine>
+
+#define COUCHDB_HAS_COROUTINES
+
+template <typename T>
+class CouchAwaitable
+{
+public:
+    using Parser = std::function<T(const QByteArray &)>;
+
+    CouchAwaitable(CouchResponse *response, const Parser &parse)
+        : m_response(response), m_parse(parse) { }
+
+    bool await_ready() const noexcept { return !m_response; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        bool suspended = CouchAwait::watch(m_response,
+            [this, handle](const QByteArray &data) {
+                m_result = CouchResult<T>(m_parse(data));
+                handle.resume();
+            },
+            [this, handle](const CouchError &error) {
+                m_result = CouchResult<T>(error);
+                handle.resume();
+            });
+        if (!suspended)
+            m_result = CouchResult<T>(CouchError(QStringLiteral("InvalidRequest"), QStringLiteral("The client of the request is gone")));
+        return suspended;
+    }
+
+    CouchResult<T> await_resume() const
+    {
+        if (!m_response)
+            return CouchResult<T>(CouchError(QStringLiteral("InvalidRequest"), QStringLiteral("No request was sent")));
+        return m_result;
+    }
+
+private:
+    CouchResponse *m_response = nullptr;
+    Parser m_parse;
+    CouchResult<T> m_result;
+};
+
+namespace CouchAwait
+{
+    inline CouchAwaitable<QByteArray> data(CouchResponse *response)
+    {
+        return CouchAwaitable<QByteArray>(response, [](const QByteArray &data) { return data; });
+    }
+
+    inline CouchAwaitable<CouchDocument> document(CouchResponse *response)
+    {
+        return CouchAwaitable<CouchDocument>(response, &Couch::toDocument);
+    }
+
+    inline CouchAwaitable<QList<CouchDocument>> documents(CouchResponse *response)
+    {
+        return CouchAwaitable<QList<CouchDocument>>(response, &Couch::toDocumentList);
+    }
+
+    inline CouchAwaitable<QStringList> databases(CouchResponse *response)
+    {
+        return CouchAwaitable<QStringList>(response, &Couch::toDatabaseList);
+    }
+}
+#endif // __has_include(<coroutine>)
+#endif // __cpp_impl_coroutine
+
+#endif // COUCHAWAIT_H
@@ -1,179 +1,1217 @@
 ﻿#include "couchclient.h"
+#include "couchclient_p.h"
+#include "couchfuture_p.h"
+#include "couchmetrics_p.h"
 #include "couch.h"
 #include "couchrequest.h"
 #include "couchresponse.h"
+#include "couchresponse_p.h"
+#include "couchurl_p.h"
 
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
 #include <QtCore/qloggingcategory.h>
 #include <QtCore/qmetaobject.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qtimer.h>
+#include <QtCore/qurlquery.h>
+#include <QtNetwork/qabstractnetworkcache.h>
 #include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkdiskcache.h>
 #include <QtNetwork/qnetworkreply.h>
 #include <QtNetwork/qnetworkrequest.h>
 
 Q_LOGGING_CATEGORY(lcCouchDB, "qtcouchdb", QtWarningMsg)
 
-class CouchClientPrivate
+static QByteArray basicAuth(const QString &username, const QString &password)
+{
+    return "Basic " + QByteArray(username.toUtf8() + ":" + password.toUtf8()).toBase64();
+}
+
+CouchClient::CouchClient(QObject *parent) : CouchClient(QUrl(), parent)
+{
+}
+
+CouchClient::CouchClient(const QUrl &url, QObject *parent) :
+    QObject(parent),
+    d_ptr(new CouchClientPrivate)
+{
+    Q_D(CouchClient);
+    d->q_ptr = this;
+    d->url = url;
+    d->cache.setMaxCost(0);
+    d->updateAuthorization();
+    setNetworkAccessManager(new QNetworkAccessManager(this));
+}
+
+CouchClient::~CouchClient()
+{
+    Q_D(CouchClient);
+    // the responses that go down with the client must not call back into it
+    QList<CouchResponse *> responses = findChildren<CouchResponse *>(QString(), Qt::FindDirectChildrenOnly);
+    if (d->worker)
+        responses += d->worker->findChildren<CouchResponse *>(QString(), Qt::FindDirectChildrenOnly);
+    for (CouchResponse *response : qAsConst(responses))
+        CouchResponsePrivate::get(response)->client = nullptr;
+
+    if (d->thread) {
+        d->thread->quit();
+        d->thread->wait();
+        delete d->worker;
+        delete d->thread;
+    }
+    delete d->diskCache;
+}
+
+QUrl CouchClient::url() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->url;
+}
+
+void CouchClient::setUrl(const QUrl &url)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (d->url == url)
+        return;
+
+    d->url = url;
+    d->updateAuthorization();
+    emit urlChanged(url);
+}
+
+CouchClient::Authentication CouchClient::authentication() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->authentication;
+}
+
+void CouchClient::setAuthentication(Authentication authentication)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (d->authentication == authentication)
+        return;
+
+    d->authentication = authentication;
+    d->updateAuthorization();
+    emit authenticationChanged(authentication);
+}
+
+int CouchClient::sessionTimeout() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->sessionTimeout;
+}
+
+void CouchClient::setSessionTimeout(int sessionTimeout)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    sessionTimeout = qMax(0, sessionTimeout);
+    if (d->sessionTimeout == sessionTimeout)
+        return;
+
+    d->sessionTimeout = sessionTimeout;
+    emit sessionTimeoutChanged(sessionTimeout);
+}
+
+bool CouchClient::isBusy() const
+{
+    Q_D(const CouchClient);
+    // the last reported values can be read without waiting for the worker thread
+    if (d->thread)
+        return d->reportedBusy.loadAcquire();
+
+    return d->activeRequests > 0 || d->retryingRequests > 0 || d->queuedRequests() > 0;
+}
+
+int CouchClient::activeRequests() const
+{
+    Q_D(const CouchClient);
+    if (d->thread)
+        return d->reportedActiveRequests.loadAcquire();
+
+    return d->activeRequests;
+}
+
+int CouchClient::queuedRequests() const
+{
+    Q_D(const CouchClient);
+    if (d->thread)
+        return d->reportedQueuedRequests.loadAcquire();
+
+    return d->queuedRequests();
+}
+
+int CouchClient::queuedRequests(CouchRequest::Priority priority) const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (priority < 0 || priority >= PriorityCount)
+        return 0;
+
+    return d->queues[priority].count();
+}
+
+int CouchClient::maxActiveRequests() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->maxActiveRequests;
+}
+
+void CouchClient::setMaxActiveRequests(int maxActiveRequests)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    maxActiveRequests = qMax(0, maxActiveRequests);
+    if (d->maxActiveRequests == maxActiveRequests)
+        return;
+
+    d->maxActiveRequests = maxActiveRequests;
+    emit maxActiveRequestsChanged(maxActiveRequests);
+
+    d->scheduleRequests();
+}
+
+bool CouchClient::isCompressionEnabled() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->compressionEnabled;
+}
+
+void CouchClient::setCompressionEnabled(bool compressionEnabled)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (d->compressionEnabled == compressionEnabled)
+        return;
+
+    d->compressionEnabled = compressionEnabled;
+    emit compressionEnabledChanged(compressionEnabled);
+}
+
+int CouchClient::compressionThreshold() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->compressionThreshold;
+}
+
+void CouchClient::setCompressionThreshold(int compressionThreshold)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    compressionThreshold = qMax(0, compressionThreshold);
+    if (d->compressionThreshold == compressionThreshold)
+        return;
+
+    d->compressionThreshold = compressionThreshold;
+    emit compressionThresholdChanged(compressionThreshold);
+}
+
+qreal CouchClient::compressionRatio() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (d->compressedBytes <= 0)
+        return 1.0;
+
+    return qreal(d->uncompressedBytes) / d->compressedBytes;
+}
+
+bool CouchClient::autoDeleteResponses() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->autoDeleteResponses;
+}
+
+void CouchClient::setAutoDeleteResponses(bool autoDeleteResponses)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (d->autoDeleteResponses == autoDeleteResponses)
+        return;
+
+    d->autoDeleteResponses = autoDeleteResponses;
+    emit autoDeleteResponsesChanged(autoDeleteResponses);
+}
+
+int CouchClient::responsePoolSize() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->responsePoolSize;
+}
+
+void CouchClient::setResponsePoolSize(int responsePoolSize)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    responsePoolSize = qMax(0, responsePoolSize);
+    if (d->responsePoolSize == responsePoolSize)
+        return;
+
+    d->responsePoolSize = responsePoolSize;
+    while (d->responsePool.count() > responsePoolSize)
+        delete d->responsePool.takeLast();
+    emit responsePoolSizeChanged(responsePoolSize);
+}
+
+int CouchClient::timeout() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->timeout;
+}
+
+void CouchClient::setTimeout(int timeout)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    timeout = qMax(0, timeout);
+    if (d->timeout == timeout)
+        return;
+
+    d->timeout = timeout;
+    emit timeoutChanged(timeout);
+}
+
+int CouchClient::connectTimeout() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->connectTimeout;
+}
+
+void CouchClient::setConnectTimeout(int connectTimeout)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    connectTimeout = qMax(0, connectTimeout);
+    if (d->connectTimeout == connectTimeout)
+        return;
+
+    d->connectTimeout = connectTimeout;
+    emit connectTimeoutChanged(connectTimeout);
+}
+
+CouchRetryPolicy CouchClient::retryPolicy() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->retryPolicy;
+}
+
+void CouchClient::setRetryPolicy(const CouchRetryPolicy &retryPolicy)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (d->retryPolicy == retryPolicy)
+        return;
+
+    d->retryPolicy = retryPolicy;
+    emit retryPolicyChanged(retryPolicy);
+}
+
+bool CouchClient::isCoalescingEnabled() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->coalescingEnabled;
+}
+
+void CouchClient::setCoalescingEnabled(bool coalescingEnabled)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (d->coalescingEnabled == coalescingEnabled)
+        return;
+
+    d->coalescingEnabled = coalescingEnabled;
+    emit coalescingEnabledChanged(coalescingEnabled);
+}
+
+int CouchClient::coalescedRequests() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->coalescedRequests;
+}
+
+int CouchClient::cacheSize() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->cache.maxCost();
+}
+
+void CouchClient::setCacheSize(int cacheSize)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    cacheSize = qMax(0, cacheSize);
+    if (d->cache.maxCost() == cacheSize)
+        return;
+
+    d->cache.setMaxCost(cacheSize);
+    emit cacheSizeChanged(cacheSize);
+}
+
+int CouchClient::cacheHits() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->cacheHits;
+}
+
+int CouchClient::cacheMisses() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->cacheMisses;
+}
+
+int CouchClient::cacheRevalidations() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->cacheRevalidations;
+}
+
+QString CouchClient::cacheDirectory() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (!d->diskCache)
+        return QString();
+
+    return d->diskCache->cacheDirectory();
+}
+
+void CouchClient::setCacheDirectory(const QString &cacheDirectory)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (this->cacheDirectory() == cacheDirectory)
+        return;
+
+    if (cacheDirectory.isEmpty()) {
+        d->diskCache->deleteLater();
+        d->diskCache = nullptr;
+    } else {
+        if (!d->diskCache) {
+            // the cache lives with the replies it stores
+            d->diskCache = new QNetworkDiskCache;
+            if (d->thread)
+                d->diskCache->moveToThread(d->thread);
+        }
+        d->diskCache->setCacheDirectory(cacheDirectory);
+    }
+    emit cacheDirectoryChanged(cacheDirectory);
+}
+
+void CouchClient::clearCache()
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    d->cache.clear();
+    if (d->diskCache)
+        d->diskCache->clear();
+}
+
+bool CouchClient::isThreaded() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->thread;
+}
+
+void CouchClient::setThreaded(bool threaded)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (!!d->thread == threaded)
+        return;
+
+    // the worker delivers what it has finished before it is left behind
+    if (!threaded && QThread::currentThread() != d->thread) {
+        QObject *worker = d->worker;
+        locker.unlock();
+        QMetaObject::invokeMethod(worker, [=]() { d->flushDeliveries(); }, Qt::BlockingQueuedConnection);
+        locker.relock();
+        if (!d->thread)
+            return;
+    }
+
+    if (d->activeRequests > 0 || d->retryingRequests > 0 || d->queuedRequests() > 0 || d->sessionReply) {
+        qCWarning(lcCouchDB) << "Cannot change the threading of a busy client";
+        return;
+    }
+
+    // pooled responses belong to the thread that is being left behind
+    for (CouchResponse *response : qAsConst(d->responsePool))
+        response->deleteLater();
+    d->responsePool.clear();
+
+    QNetworkAccessManager *networkAccessManager = d->networkAccessManager;
+    bool ownsNetworkAccessManager = d->ownsNetworkAccessManager();
+    if (ownsNetworkAccessManager) {
+        networkAccessManager->deleteLater();
+        d->networkAccessManager = nullptr;
+    } else if (networkAccessManager->parent()) {
+        qCWarning(lcCouchDB) << "Cannot move a network access manager with a parent to another thread";
+        return;
+    }
+
+    if (threaded) {
+        d->thread = new QThread;
+        d->thread->setObjectName(QStringLiteral("CouchClient"));
+        d->worker = new QObject;
+        d->worker->moveToThread(d->thread);
+        d->thread->start();
+
+        if (ownsNetworkAccessManager) {
+            networkAccessManager = new QNetworkAccessManager;
+            networkAccessManager->moveToThread(d->thread);
+            QMetaObject::invokeMethod(d->worker, [=]() { networkAccessManager->setParent(d->worker); }, Qt::QueuedConnection);
+        } else {
+            networkAccessManager->moveToThread(d->thread);
+        }
+        if (d->diskCache)
+            d->diskCache->moveToThread(d->thread);
+    } else {
+        QThread *workerThread = d->thread;
+        QObject *worker = d->worker;
+        d->thread = nullptr;
+        d->worker = nullptr;
+
+        // the worker may be waiting for the lock, and objects can only be
+        // pushed away by the thread they live in
+        locker.unlock();
+        QThread *clientThread = thread();
+        if (!ownsNetworkAccessManager)
+            QMetaObject::invokeMethod(worker, [=]() { networkAccessManager->moveToThread(clientThread); }, Qt::BlockingQueuedConnection);
+        if (QNetworkDiskCache *diskCache = d->diskCache)
+            QMetaObject::invokeMethod(worker, [=]() { diskCache->moveToThread(clientThread); }, Qt::BlockingQueuedConnection);
+        workerThread->quit();
+        workerThread->wait();
+        delete worker;
+        delete workerThread;
+        locker.relock();
+
+        if (ownsNetworkAccessManager)
+            networkAccessManager = new QNetworkAccessManager(this);
+    }
+
+    d->networkAccessManager = networkAccessManager;
+    d->sessionReply = nullptr;
+    d->connectNetworkAccessManager();
+    emit threadedChanged(threaded);
+}
+
+int CouchClient::parallelDecodingThreshold() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->parallelDecodingThreshold;
+}
+
+void CouchClient::setParallelDecodingThreshold(int parallelDecodingThreshold)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    parallelDecodingThreshold = qMax(0, parallelDecodingThreshold);
+    if (d->parallelDecodingThreshold == parallelDecodingThreshold)
+        return;
+
+    d->parallelDecodingThreshold = parallelDecodingThreshold;
+    emit parallelDecodingThresholdChanged(parallelDecodingThreshold);
+}
+
+CouchMetrics CouchClient::metrics() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->metrics;
+}
+
+void CouchClient::resetMetrics()
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    d->metrics = CouchMetrics();
+}
+
+int CouchClient::slowRequestThreshold() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->slowRequestThreshold;
+}
+
+void CouchClient::setSlowRequestThreshold(int slowRequestThreshold)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    slowRequestThreshold = qMax(0, slowRequestThreshold);
+    if (d->slowRequestThreshold == slowRequestThreshold)
+        return;
+
+    d->slowRequestThreshold = slowRequestThreshold;
+    emit slowRequestThresholdChanged(slowRequestThreshold);
+}
+
+int CouchClient::traceBufferSize() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->tracer.capacity();
+}
+
+void CouchClient::setTraceBufferSize(int traceBufferSize)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    traceBufferSize = qMax(0, traceBufferSize);
+    if (d->tracer.capacity() == traceBufferSize)
+        return;
+
+    d->tracer.setCapacity(traceBufferSize);
+    emit traceBufferSizeChanged(traceBufferSize);
+}
+
+QByteArray CouchClient::exportTrace() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->tracer.toJson();
+}
+
+void CouchClient::clearTrace()
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    d->tracer.clear();
+}
+
+QNetworkAccessManager *CouchClient::networkAccessManager() const
+{
+    Q_D(const CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return d->networkAccessManager;
+}
+
+void CouchClient::setNetworkAccessManager(QNetworkAccessManager *networkAccessManager)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (!networkAccessManager)
+        return;
+
+    if (d->thread && networkAccessManager->thread() != d->thread) {
+        if (networkAccessManager->parent()) {
+            qCWarning(lcCouchDB) << "Cannot move a network access manager with a parent to another thread";
+            return;
+        }
+        networkAccessManager->moveToThread(d->thread);
+    }
+
+    if (d->networkAccessManager) {
+        if (d->ownsNetworkAccessManager())
+            d->networkAccessManager->deleteLater();
+        else
+            QObject::disconnect(d->finishedConnection);
+    }
+
+    d->networkAccessManager = networkAccessManager;
+    d->sessionReply = nullptr;
+    d->sessionTimer.invalidate();
+    d->connectNetworkAccessManager();
+}
+
+QObject *CouchClientPrivate::context() const
+{
+    Q_Q(const CouchClient);
+    if (worker)
+        return worker;
+    return const_cast<CouchClient *>(q);
+}
+
+bool CouchClientPrivate::ownsNetworkAccessManager() const
+{
+    Q_Q(const CouchClient);
+    QObject *parent = networkAccessManager ? networkAccessManager->parent() : nullptr;
+    return parent && (parent == q || parent == worker);
+}
+
+void CouchClientPrivate::connectNetworkAccessManager()
+{
+    // without a receiver the replies are handled in the thread of the manager
+    QObject::disconnect(finishedConnection);
+    finishedConnection = QObject::connect(networkAccessManager, &QNetworkAccessManager::finished, [=](QNetworkReply *reply) {
+        QMutexLocker locker(&mutex);
+        queryFinished(reply);
+    });
+}
+
+QFuture<QStringList> CouchClient::fetchDatabases()
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    return CouchFuture::fetch<QStringList>(this, Couch::listDatabases(d->url), &Couch::toDatabaseList);
+}
+
+CouchResponse *CouchClient::listDatabases()
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    CouchRequest request = Couch::listDatabases(d->url);
+    CouchResponse *response = sendRequest(request);
+    if (!response)
+        return nullptr;
+
+    connect(response, &CouchResponse::received, [=](const QByteArray &data) {
+        emit databasesListed(Couch::toDatabaseList(data));
+    });
+    return response;
+}
+
+CouchResponse *CouchClient::createDatabase(const QString &database)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    CouchRequest request = Couch::createDatabase(Couch::databaseUrl(d->url, database));
+    CouchResponse *response = sendRequest(request);
+    if (!response)
+        return nullptr;
+
+    connect(response, &CouchResponse::received, [=](const QByteArray &data) {
+        emit databaseCreated(Couch::toDatabase(data));
+    });
+    return response;
+}
+
+CouchResponse *CouchClient::deleteDatabase(const QString &database)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    CouchRequest request = Couch::deleteDatabase(Couch::databaseUrl(d->url, database));
+    CouchResponse *response = sendRequest(request);
+    if (!response)
+        return nullptr;
+
+    connect(response, &CouchResponse::received, [=](const QByteArray &data) {
+        emit databaseDeleted(Couch::toDatabase(data));
+    });
+    return response;
+}
+
+CouchResponse *CouchClient::sendRequest(const CouchRequest &request)
+{
+    Q_D(CouchClient);
+    QMutexLocker locker(&d->mutex);
+    if (!request.isValid())
+        return nullptr;
+
+    CouchResponse *response = d->createResponse(request);
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->elapsed.start();
+    r->mark(CouchResponse::Enqueued);
+    r->endpoint = CouchMetrics::endpoint(request.url(), d->url);
+    d->startTimeout(response);
+    if (d->replayFromCache(response))
+        return response;
+
+    if (CouchResponse *leader = d->coalescingResponse(request)) {
+        // an identical GET is already pending, share its result instead of sending another
+        CouchResponsePrivate::get(leader)->followers += response;
+        CouchResponsePrivate::get(response)->leader = leader;
+        ++d->coalescedRequests;
+        return response;
+    }
+
+    if (d->coalescingEnabled && request.operation() == CouchRequest::Get)
+        d->pendingGets.insert(request.url(), response);
+
+    d->enqueueRequest(response);
+    if (d->thread && QThread::currentThread() == thread()) {
+        // like a reply, the dispatch waits for the caller to connect to the response
+        d->updateRequests();
+        QMetaObject::invokeMethod(this, [d]() {
+            QMutexLocker locker(&d->mutex);
+            d->scheduleRequests();
+        }, Qt::QueuedConnection);
+    } else {
+        d->scheduleRequests();
+    }
+    return response;
+}
+
+CouchResponse *CouchClientPrivate::createResponse(const CouchRequest &request)
+{
+    Q_Q(CouchClient);
+    if (responsePool.isEmpty()) {
+        if (!thread) {
+            CouchResponse *response = new CouchResponse(request, q);
+            CouchResponsePrivate::get(response)->client = this;
+            return response;
+        }
+
+        // responses live with their replies, the worker adopts them in its own thread
+        CouchResponse *response = new CouchResponse(request);
+        CouchResponsePrivate::get(response)->client = this;
+        response->moveToThread(thread);
+        QPointer<CouchResponse> pointer(response);
+        QObject *worker = this->worker;
+        QMetaObject::invokeMethod(worker, [=]() {
+            if (pointer && !pointer->parent())
+                pointer->setParent(worker);
+        }, Qt::QueuedConnection);
+        return response;
+    }
+
+    CouchResponse *response = responsePool.takeLast();
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->request = request;
+    r->finished = false;
+    return response;
+}
+
+void CouchClientPrivate::releaseResponse(CouchResponse *response)
+{
+    if (!autoDeleteResponses)
+        return;
+
+    if (responsePool.count() >= responsePoolSize) {
+        response->deleteLater();
+        return;
+    }
+
+    // recycled responses keep no connections from their previous request
+    response->disconnect();
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->reset();
+    r->client = this;
+    r->finished = true;
+    responsePool += response;
+}
+
+CouchResponse *CouchClientPrivate::sendRequest(const CouchRequest &request,
+                                               const std::function<void(const QByteArray &)> &onReceived,
+                                               const std::function<void(const CouchError &)> &onError)
+{
+    Q_Q(CouchClient);
+    // replies always arrive asynchronously, and the worker thread cannot
+    // deliver them before the handlers are in place while this is locked
+    QMutexLocker locker(&mutex);
+    CouchResponse *response = q->sendRequest(request);
+    if (response) {
+        CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+        r->onReceived = onReceived;
+        r->onError = onError;
+    }
+    return response;
+}
+
+int CouchClientPrivate::queuedRequests() const
 {
-    Q_DECLARE_PUBLIC(CouchClient)
+    int count = 0;
+    for (const auto &queue : queues)
+        count += queue.count();
+    return count;
+}
 
-public:
-    void queryFinished(QNetworkReply *reply);
+void CouchClientPrivate::updateAuthorization()
+{
+    // the credentials only change with the url, so the header is encoded once
+    authorization.clear();
+    QString username = url.userName();
+    QString password = url.password();
+    if (authentication == CouchClient::BasicAuthentication && !username.isEmpty() && !password.isEmpty())
+        authorization = basicAuth(username, password);
+
+    sessionTimer.invalidate();
+    sessionFailed = false;
+}
+
+bool CouchClientPrivate::needsSession() const
+{
+    if (authentication != CouchClient::SessionAuthentication || sessionFailed)
+        return false;
+
+    if (url.userName().isEmpty() || url.password().isEmpty())
+        return false;
+
+    // refresh the session a bit before the server expires it
+    if (!sessionTimer.isValid())
+        return true;
+
+    return sessionTimeout > 0 && sessionTimer.hasExpired(sessionTimeout * 900);
+}
+
+void CouchClientPrivate::startSession()
+{
+    if (sessionReply)
+        return;
+
+    QJsonObject credentials;
+    credentials.insert(QStringLiteral("name"), url.userName());
+    credentials.insert(QStringLiteral("password"), url.password());
+    QByteArray body = QJsonDocument(credentials).toJson(QJsonDocument::Compact);
+
+    QNetworkRequest networkRequest(CouchUrl::resolve(url.adjusted(QUrl::RemoveUserInfo), QStringLiteral("_session")));
+    networkRequest.setPriority(QNetworkRequest::HighPriority);
+    networkRequest.setRawHeader("Accept", "application/json");
+    networkRequest.setRawHeader("Content-Type", "application/json");
+    networkRequest.setRawHeader("Content-Length", QByteArray::number(body.size()));
+
+    qCDebug(lcCouchDB) << "Starting session for" << url.userName();
+    sessionReply = networkAccessManager->post(networkRequest, body);
+}
+
+void CouchClientPrivate::sessionFinished(QNetworkReply *reply)
+{
+    Q_Q(CouchClient);
+    sessionReply = nullptr;
+    reply->deleteLater();
+
+    QNetworkReply::NetworkError networkError = reply->error();
+    if (networkError == QNetworkReply::NoError) {
+        // the AuthSession cookie is stored and sent by the cookie jar
+        sessionTimer.start();
+    } else {
+        // let the queued requests through, they report their own errors
+        sessionTimer.invalidate();
+        sessionFailed = true;
+
+        QByteArray key = QMetaEnum::fromType<QNetworkReply::NetworkError>().valueToKey(networkError);
+        int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        CouchError error(code, QString::fromLatin1(key), reply->errorString());
+        qCWarning(lcCouchDB) << error;
+        emit q->errorOccurred(error);
+    }
 
-    QUrl url;
-    int activeRequests = 0;
-    CouchClient *q_ptr = nullptr;
-    QNetworkAccessManager *networkAccessManager = nullptr;
-};
+    scheduleRequests();
+}
 
-CouchClient::CouchClient(QObject *parent) : CouchClient(QUrl(), parent)
+int CouchClientPrivate::nextPriority()
 {
+    // serve the highest non-empty lane, unless a lower lane has been passed
+    // over too many times in a row, in which case it gets the next slot
+    int next = -1;
+    for (int priority = 0; priority < PriorityCount; ++priority) {
+        if (queues[priority].isEmpty())
+            continue;
+        if (next == -1 || skippedDispatches[priority] >= MaxSkippedDispatches)
+            next = priority;
+    }
+
+    for (int priority = 0; priority < PriorityCount; ++priority) {
+        if (priority == next || queues[priority].isEmpty())
+            skippedDispatches[priority] = 0;
+        else
+            ++skippedDispatches[priority];
+    }
+    return next;
 }
 
-CouchClient::CouchClient(const QUrl &url, QObject *parent) :
-    QObject(parent),
-    d_ptr(new CouchClientPrivate)
+CouchResponse *CouchClientPrivate::coalescingResponse(const CouchRequest &request) const
 {
-    Q_D(CouchClient);
-    d->q_ptr = this;
-    d->url = url;
-    setNetworkAccessManager(new QNetworkAccessManager(this));
+    if (!coalescingEnabled || request.operation() != CouchRequest::Get)
+        return nullptr;
+
+    CouchResponse *leader = pendingGets.value(request.url());
+    if (!leader || leader->request() != request)
+        return nullptr;
+
+    // streamed rows are emitted as they arrive and cannot be shared
+    CouchResponsePrivate *r = CouchResponsePrivate::get(leader);
+    if (r->batchSize > 0 || r->rowsDelivered)
+        return nullptr;
+
+    return leader;
 }
 
-CouchClient::~CouchClient()
+static bool isRevisionPinned(const CouchRequest &request)
 {
+    return request.operation() == CouchRequest::Get && QUrlQuery(request.url()).hasQueryItem(QStringLiteral("rev"));
 }
 
-QUrl CouchClient::url() const
+static QUrl diskCacheUrl(const QUrl &url)
 {
-    Q_D(const CouchClient);
-    return d->url;
+    return url.adjusted(QUrl::RemoveUserInfo);
 }
 
-void CouchClient::setUrl(const QUrl &url)
+bool CouchClientPrivate::replayFromCache(CouchResponse *response)
 {
-    Q_D(CouchClient);
-    if (d->url == url)
-        return;
+    Q_Q(CouchClient);
+    const CouchRequest request = response->request();
+    if (!isRevisionPinned(request))
+        return false;
 
-    d->url = url;
-    emit urlChanged(url);
-}
+    // a specific revision of a document never changes, so no revalidation is needed
+    QByteArray data;
+    if (const CouchCacheEntry *entry = cache.object(request.url())) {
+        data = entry->data;
+    } else if (diskCache) {
+        QScopedPointer<QIODevice> device(diskCache->data(diskCacheUrl(request.url())));
+        if (!device)
+            return false;
+        data = device->readAll();
+        cache.insert(request.url(), new CouchCacheEntry{QByteArray(), data}, data.size());
+    } else {
+        return false;
+    }
 
-bool CouchClient::isBusy() const
-{
-    Q_D(const CouchClient);
-    return d->activeRequests > 0;
+    ++cacheHits;
+    qCDebug(lcCouchDB) << "Cached" << request;
+
+    // replayed in the caller's thread, which has to return before it can connect
+    QObject *context = QThread::currentThread() == q->thread() ? q : this->context();
+    QPointer<CouchResponse> pointer(response);
+    int generation = CouchResponsePrivate::get(response)->generation;
+    QMetaObject::invokeMethod(context, [=]() {
+        QMutexLocker locker(&mutex);
+        if (pointer && CouchResponsePrivate::get(pointer)->generation == generation && !CouchResponsePrivate::get(pointer)->finished)
+            replayResponse(pointer, data);
+    }, Qt::QueuedConnection);
+    return true;
 }
 
-QNetworkAccessManager *CouchClient::networkAccessManager() const
+void CouchClientPrivate::releaseFollowers(CouchResponse *response)
 {
-    Q_D(const CouchClient);
-    return d->networkAccessManager;
+    // an aborted request does not take the requests coalesced into it down
+    // with it, the first one takes over and the rest follow that instead
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    if (pendingGets.value(r->request.url()) == response)
+        pendingGets.remove(r->request.url());
+
+    const QList<QPointer<CouchResponse>> followers = r->followers;
+    r->followers.clear();
+
+    CouchResponse *leader = nullptr;
+    for (CouchResponse *follower : followers) {
+        if (!follower)
+            continue;
+
+        CouchResponsePrivate *f = CouchResponsePrivate::get(follower);
+        if (!leader) {
+            leader = follower;
+            f->leader = nullptr;
+            pendingGets.insert(f->request.url(), leader);
+            enqueueRequest(leader);
+        } else {
+            f->leader = leader;
+            CouchResponsePrivate::get(leader)->followers += follower;
+        }
+    }
 }
 
-void CouchClient::setNetworkAccessManager(QNetworkAccessManager *networkAccessManager)
+void CouchClientPrivate::abortRequest(CouchResponse *response, const CouchError &error)
 {
-    Q_D(CouchClient);
-    if (!networkAccessManager)
+    QMutexLocker locker(&mutex);
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    if (r->finished || r->aborted)
         return;
 
-    if (d->networkAccessManager) {
-        if (d->networkAccessManager->parent() == this)
-            d->networkAccessManager->deleteLater();
-        else
-            d->networkAccessManager->disconnect(this);
+    r->aborted = true;
+    r->abortError = error;
+
+    // a request on the wire is reported once its reply has finished
+    if (r->reply) {
+        QMetaObject::invokeMethod(r->reply, "abort");
+        return;
     }
 
-    d->networkAccessManager = networkAccessManager;
-    connect(networkAccessManager, &QNetworkAccessManager::finished, [=](QNetworkReply *reply) { d->queryFinished(reply); });
+    // queued, waiting for a retry, coalesced, or being replayed from the cache
+    for (auto &queue : queues)
+        queue.removeAll(response);
+    if (r->leader)
+        CouchResponsePrivate::get(r->leader)->followers.removeAll(response);
+    releaseFollowers(response);
+
+    qCWarning(lcCouchDB) << error;
+    finishResponse(response, QByteArray(), error, true);
+
+    scheduleRequests();
 }
 
-CouchResponse *CouchClient::listDatabases()
+void CouchClientPrivate::dropRequest(CouchResponse *response)
 {
-    Q_D(CouchClient);
-    CouchRequest request = Couch::listDatabases(d->url);
-    CouchResponse *response = sendRequest(request);
-    if (!response)
-        return nullptr;
+    // a deleted request does not take the requests coalesced into it down with it
+    QMutexLocker locker(&mutex);
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    if (r->reply)
+        QMetaObject::invokeMethod(r->reply, "abort", Qt::QueuedConnection);
 
-    connect(response, &CouchResponse::received, [=](const QByteArray &data) {
-        emit databasesListed(Couch::toDatabaseList(data));
-    });
-    return response;
+    for (auto &queue : queues)
+        queue.removeAll(response);
+    if (r->leader)
+        CouchResponsePrivate::get(r->leader)->followers.removeAll(response);
+    releaseFollowers(response);
+
+    scheduleRequests();
 }
 
-CouchResponse *CouchClient::createDatabase(const QString &database)
+static CouchError timeoutError(int timeout)
 {
-    Q_D(CouchClient);
-    CouchRequest request = Couch::createDatabase(Couch::databaseUrl(d->url, database));
-    CouchResponse *response = sendRequest(request);
-    if (!response)
-        return nullptr;
+    return CouchError(0, QStringLiteral("TimeoutError"), QStringLiteral("Request timed out after %1 ms").arg(timeout));
+}
 
-    connect(response, &CouchResponse::received, [=](const QByteArray &data) {
-        emit databaseCreated(Couch::toDatabase(data));
+void CouchClientPrivate::startTimeout(CouchResponse *response)
+{
+    // the timeout covers the whole request, including the time it spends
+    // queued and waiting for retries, not only a single attempt
+    const CouchRequest &request = CouchResponsePrivate::get(response)->request;
+    int timeout = request.timeout() >= 0 ? request.timeout() : this->timeout;
+    if (timeout <= 0)
+        return;
+
+    QPointer<CouchResponse> pointer(response);
+    int generation = CouchResponsePrivate::get(response)->generation;
+    QTimer::singleShot(timeout, context(), [=]() {
+        QMutexLocker locker(&mutex);
+        if (pointer && CouchResponsePrivate::get(pointer)->generation == generation)
+            abortRequest(pointer, timeoutError(timeout));
     });
-    return response;
 }
 
-CouchResponse *CouchClient::deleteDatabase(const QString &database)
+void CouchClientPrivate::enqueueRequest(CouchResponse *response)
 {
-    Q_D(CouchClient);
-    CouchRequest request = Couch::deleteDatabase(Couch::databaseUrl(d->url, database));
-    CouchResponse *response = sendRequest(request);
-    if (!response)
-        return nullptr;
+    int priority = qBound<int>(CouchRequest::Interactive, response->request().priority(), CouchRequest::Bulk);
+    queues[priority].enqueue(response);
+}
 
-    connect(response, &CouchResponse::received, [=](const QByteArray &data) {
-        emit databaseDeleted(Couch::toDatabase(data));
-    });
-    return response;
+void CouchClientPrivate::scheduleRequests()
+{
+    // the network access manager can only be used from its own thread
+    if (!thread || QThread::currentThread() == thread) {
+        dispatchRequests();
+        updateRequests();
+        return;
+    }
+
+    updateRequests();
+    if (dispatchScheduled)
+        return;
+
+    dispatchScheduled = true;
+    QMetaObject::invokeMethod(worker, [=]() {
+        QMutexLocker locker(&mutex);
+        dispatchScheduled = false;
+        dispatchRequests();
+        updateRequests();
+    }, Qt::QueuedConnection);
 }
 
-static QByteArray basicAuth(const QString &username, const QString &password)
+void CouchClientPrivate::dispatchRequests()
 {
-    return "Basic " + QByteArray(username.toUtf8() + ":" + password.toUtf8()).toBase64();
+    if (queuedRequests() > 0 && needsSession()) {
+        startSession();
+        return;
+    }
+
+    while (maxActiveRequests <= 0 || activeRequests < maxActiveRequests) {
+        int priority = nextPriority();
+        if (priority == -1)
+            break;
+
+        QPointer<CouchResponse> response = queues[priority].dequeue();
+        if (response)
+            startRequest(response);
+    }
+
+    // the requests that waited for a failed login are on their way,
+    // the ones after them try to log in again
+    if (sessionFailed && queuedRequests() == 0)
+        sessionFailed = false;
 }
 
-CouchResponse *CouchClient::sendRequest(const CouchRequest &request)
+void CouchClientPrivate::startRequest(CouchResponse *response)
 {
-    Q_D(CouchClient);
-    if (!request.isValid())
-        return nullptr;
+    CouchRequest request = response->request();
+    QUrl requestUrl = request.url();
+    if (authentication == CouchClient::SessionAuthentication)
+        requestUrl = requestUrl.adjusted(QUrl::RemoveUserInfo);
 
-    CouchResponse *response = new CouchResponse(request, this);
-    QNetworkRequest networkRequest(request.url());
+    QNetworkRequest networkRequest(requestUrl);
     networkRequest.setOriginatingObject(response);
+    if (request.priority() == CouchRequest::Interactive)
+        networkRequest.setPriority(QNetworkRequest::HighPriority);
+    else if (request.priority() == CouchRequest::Bulk)
+        networkRequest.setPriority(QNetworkRequest::LowPriority);
 
     const auto headers = request.headers();
     for (auto it = headers.cbegin(); it != headers.cend(); ++it)
         networkRequest.setRawHeader(it.key(), it.value());
 
-    QString username = d->url.userName();
-    QString password = d->url.password();
-    if (!username.isEmpty() && !password.isEmpty())
-        networkRequest.setRawHeader("Authorization", basicAuth(username, password));
+    if (!authorization.isEmpty())
+        networkRequest.setRawHeader("Authorization", authorization);
+
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->acceptEncoding = compressionEnabled;
+    ++r->attempts;
+    r->mark(CouchResponse::Dispatched);
+    r->timestamps[CouchResponse::FirstByte] = -1;
+
+    r->cachedEtag.clear();
+    r->cachedData.clear();
+    if (request.operation() == CouchRequest::Get && !networkRequest.hasRawHeader("If-None-Match")) {
+        const CouchCacheEntry *entry = cache.object(request.url());
+        if (entry && !entry->etag.isEmpty()) {
+            // the body is kept with the response in case the entry is evicted before the reply
+            r->cachedEtag = entry->etag;
+            r->cachedData = entry->data;
+            networkRequest.setRawHeader("If-None-Match", entry->etag);
+            ++cacheRevalidations;
+        }
+    }
+    if (compressionEnabled)
+        networkRequest.setRawHeader("Accept-Encoding", "gzip, deflate");
 
     QByteArray body = request.body();
     if (!body.isEmpty()) {
+        // only bulk uploads, such as _bulk_docs, are worth compressing
+        if (compressionEnabled && compressionThreshold > 0 && request.priority() == CouchRequest::Bulk &&
+            body.size() >= compressionThreshold) {
+            QByteArray compressed = CouchCompression::gzip(body);
+            if (!compressed.isEmpty() && compressed.size() < body.size()) {
+                uncompressedBytes += body.size();
+                compressedBytes += compressed.size();
+                networkRequest.setRawHeader("Content-Encoding", "gzip");
+                body = compressed;
+            }
+        }
         networkRequest.setRawHeader("Accept", "application/json");
         networkRequest.setRawHeader("Content-Type", "application/json");
         networkRequest.setRawHeader("Content-Length", QByteArray::number(body.size()));
+        metricsSeries(r).bytesSent += body.size();
+        r->bytesSent += body.size();
     }
 
     qCDebug(lcCouchDB) << request;
 
+    QNetworkReply *reply = nullptr;
     switch (request.operation()) {
     case CouchRequest::Get:
-        d->networkAccessManager->get(networkRequest);
+        reply = networkAccessManager->get(networkRequest);
         break;
     case CouchRequest::Put:
-        d->networkAccessManager->put(networkRequest, request.body());
+        reply = networkAccessManager->put(networkRequest, body);
         break;
     case CouchRequest::Post:
-        d->networkAccessManager->post(networkRequest, request.body());
+        reply = networkAccessManager->post(networkRequest, body);
         break;
     case CouchRequest::Delete:
-        d->networkAccessManager->deleteResource(networkRequest);
+        reply = networkAccessManager->deleteResource(networkRequest);
         break;
     // LCOV_EXCL_START
     default:
@@ -182,38 +1220,514 @@ CouchResponse *CouchClient::sendRequest(const CouchRequest &request)
     // LCOV_EXCL_STOP
     }
 
-    if (++d->activeRequests == 1)
-        emit busyChanged(true);
+    QObject::connect(reply, &QNetworkReply::readyRead, [=]() {
+        QMutexLocker locker(&mutex);
+        readyRead(reply);
+    });
+    r->reply = reply;
 
-    return response;
+    QPointer<CouchResponse> pointer(response);
+    int generation = r->generation;
+
+    // there is no signal for an established connection, so the response
+    // headers have to arrive within the connect timeout instead
+    int connectTimeout = request.connectTimeout() >= 0 ? request.connectTimeout() : this->connectTimeout;
+    if (connectTimeout > 0) {
+        QTimer *timer = new QTimer(reply);
+        timer->setSingleShot(true);
+        QObject::connect(timer, &QTimer::timeout, [=]() {
+            QMutexLocker locker(&mutex);
+            if (pointer && CouchResponsePrivate::get(pointer)->generation == generation)
+                abortRequest(pointer, timeoutError(connectTimeout));
+        });
+        QObject::connect(reply, &QNetworkReply::metaDataChanged, timer, &QTimer::stop);
+        QObject::connect(reply, &QNetworkReply::readyRead, timer, &QTimer::stop);
+        timer->start(connectTimeout);
+    }
+
+    ++activeRequests;
+}
+
+QByteArray CouchClientPrivate::readReply(QNetworkReply *reply, CouchResponsePrivate *response)
+{
+    QByteArray data = reply->readAll();
+    metricsSeries(response).bytesReceived += data.size();
+    response->bytesReceived += data.size();
+    if (!response->acceptEncoding)
+        return data;
+
+    if (!response->encodingChecked) {
+        if (CouchCompression::isSupported(reply->rawHeader("Content-Encoding")))
+            response->inflater.reset(new CouchInflater);
+        response->encodingChecked = true;
+    }
+
+    // like request bodies, replies only count towards the ratio when encoded
+    if (response->inflater) {
+        compressedBytes += data.size();
+        QByteArray decoded;
+        response->inflater->decode(data, &decoded);
+        data = decoded;
+        uncompressedBytes += data.size();
+    }
+    return data;
+}
+
+void CouchClientPrivate::readyRead(QNetworkReply *reply)
+{
+    CouchResponse *response = qobject_cast<CouchResponse *>(reply->request().originatingObject());
+    if (!response)
+        return;
+
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    if (!r->reached(CouchResponse::FirstByte))
+        r->mark(CouchResponse::FirstByte);
+    if (r->batchSize > 0) {
+        if (!r->rowParser)
+            r->rowParser.reset(new CouchRowParser);
+
+        r->rowParser->append(readReply(reply, r));
+        QPointer<CouchResponse> pointer(response);
+        while (r->rowParser->rowCount() >= r->batchSize) {
+            r->rowsDelivered = true;
+            const QList<CouchDocument> rows = r->rowParser->takeRows(r->batchSize);
+            deliver([=]() {
+                if (pointer)
+                    emit pointer->rowsReceived(rows);
+            });
+        }
+    } else if (r->acceptEncoding) {
+        r->data += readReply(reply, r);
+    }
 }
 
 void CouchClientPrivate::queryFinished(QNetworkReply *reply)
 {
-    Q_Q(CouchClient);
+    if (reply == sessionReply) {
+        sessionFinished(reply);
+        return;
+    }
+
     CouchResponse *response = qobject_cast<CouchResponse *>(reply->request().originatingObject());
-    Q_ASSERT(response);
+    if (!response) {
+        // deleted while on the wire
+        reply->deleteLater();
+        --activeRequests;
+        dispatchRequests();
+        updateRequests();
+        return;
+    }
 
-    QByteArray data = reply->readAll();
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->mark(CouchResponse::Finished);
+    r->status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (!r->reached(CouchResponse::FirstByte))
+        r->timestamps[CouchResponse::FirstByte] = r->timestamps[CouchResponse::Finished];
+    r->reply.clear();
+    QByteArray data = readReply(reply, r);
+    bool notModified = !r->cachedEtag.isEmpty() && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == Couch::NotModifed;
+    if (notModified) {
+        data = r->cachedData;
+        r->data.clear();
+    }
+    if (r->rowParser || r->batchSize > 0) {
+        if (!r->rowParser)
+            r->rowParser.reset(new CouchRowParser);
+        r->rowParser->append(data);
+        if (r->rowParser->rowCount() > 0) {
+            QPointer<CouchResponse> pointer(response);
+            const QList<CouchDocument> rows = r->rowParser->takeRows();
+            deliver([=]() {
+                if (pointer)
+                    emit pointer->rowsReceived(rows);
+            });
+        }
+        data = r->rowParser->envelope();
+        r->rowParser.reset();
+    } else if (!r->data.isEmpty()) {
+        r->data += data;
+        data = r->data;
+    }
     response->setData(data);
 
     QNetworkReply::NetworkError networkError = reply->error();
 
-    if (networkError == QNetworkReply::NoError) {
-        emit response->received(data);
-        emit q->responseReceived(response);
+    if (r->aborted) {
+        reply->deleteLater();
+        releaseFollowers(response);
+        qCWarning(lcCouchDB) << r->abortError;
+        finishResponse(response, data, r->abortError, true);
+    } else if (networkError != QNetworkReply::NoError && shouldReauthenticate(reply, r)) {
+        // the session expired on the server, log in again and resend
+        reply->deleteLater();
+        r->reauthenticated = true;
+        r->data.clear();
+        r->inflater.reset();
+        r->encodingChecked = false;
+        sessionTimer.invalidate();
+        enqueueRequest(response);
+    } else if (networkError != QNetworkReply::NoError && shouldRetry(reply, r)) {
+        reply->deleteLater();
+        retryRequest(response);
     } else {
-        QByteArray key = QMetaEnum::fromType<QNetworkReply::NetworkError>().valueToKey(networkError);
-        int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        CouchError error(code, QString::fromLatin1(key), reply->errorString());
-        qCWarning(lcCouchDB) << error;
+        CouchError error;
+        bool failed = networkError != QNetworkReply::NoError;
+        if (!failed && r->inflater && r->inflater->hasError()) {
+            error = CouchError(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(),
+                               QStringLiteral("DecompressionError"),
+                               QStringLiteral("Invalid %1 response data").arg(QString::fromLatin1(reply->rawHeader("Content-Encoding"))));
+            failed = true;
+        } else if (failed) {
+            QByteArray key = QMetaEnum::fromType<QNetworkReply::NetworkError>().valueToKey(networkError);
+            int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            error = CouchError(code, QString::fromLatin1(key), reply->errorString());
+        }
+        if (failed)
+            qCWarning(lcCouchDB) << error;
+        else if (notModified)
+            ++cacheHits;
+        else
+            cacheReply(reply, r, data);
+
+        if (pendingGets.value(r->request.url()) == response)
+            pendingGets.remove(r->request.url());
+
+        const QList<QPointer<CouchResponse>> followers = r->followers;
+        r->followers.clear();
+
+        int attempts = r->attempts;
+        finishResponse(response, data, error, failed);
+        for (CouchResponse *follower : followers) {
+            if (!follower)
+                continue;
+
+            CouchResponsePrivate::get(follower)->attempts = attempts;
+            if (failed) {
+                follower->setData(data);
+                finishResponse(follower, data, error, failed);
+            } else {
+                replayResponse(follower, data);
+            }
+        }
+
+        reply->deleteLater();
+    }
+
+    --activeRequests;
+    dispatchRequests();
+    updateRequests();
+}
+
+void CouchClientPrivate::finishResponse(CouchResponse *response, const QByteArray &data, const CouchError &error, bool failed)
+{
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->finished = true;
+    r->failed = failed;
+    r->error = error;
+    if (!r->reached(CouchResponse::Finished))
+        r->mark(CouchResponse::Finished);
+
+    CouchMetricsSeries &series = metricsSeries(r);
+    ++series.requests;
+    if (failed)
+        ++series.errors;
+    if (r->elapsed.isValid())
+        series.latency.record(r->elapsed.nsecsElapsed() / 1000);
+
+    QPointer<CouchResponse> pointer(response);
+    deliver([=]() {
+        if (pointer)
+            deliverResponse(pointer, data, error, failed);
+    });
+}
+
+void CouchClientPrivate::deliverResponse(CouchResponse *response, const QByteArray &data, const CouchError &error, bool failed)
+{
+    Q_Q(CouchClient);
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->delivered = true;
+
+    // the typed handlers decode the data, unless they mark it themselves
+    if (failed) {
+        if (r->onError)
+            r->onError(error);
         emit response->errorOccurred(error);
+        if (!r->reached(CouchResponse::Parsed))
+            r->mark(CouchResponse::Parsed);
         emit q->errorOccurred(error);
+    } else {
+        if (r->onReceived)
+            r->onReceived(data);
+        emit response->received(data);
+        if (!r->decoding && !r->reached(CouchResponse::Parsed))
+            r->mark(CouchResponse::Parsed);
+        emit q->responseReceived(response);
     }
 
-    reply->deleteLater();
-    response->deleteLater(); // ### TODO: CouchClient::autoDeleteResponses
+    if (!r->decoding)
+        completeResponse(response, error, failed);
+}
+
+void CouchClientPrivate::completeResponse(CouchResponse *response, const CouchError &error, bool failed)
+{
+    Q_Q(CouchClient);
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    QMutexLocker locker(&mutex);
+    r->mark(CouchResponse::Delivered);
+
+    if (slowRequestThreshold > 0 && r->timestamps[CouchResponse::Delivered] >= slowRequestThreshold * 1000ll)
+        qCWarning(lcCouchDB).noquote() << "Slow request" << r->request << response->timingSummary();
+    if (tracer.isEnabled())
+        traceResponse(r, error, failed);
+
+    if (worker) {
+        // the signals emitted by the worker are still queued for the client's
+        // thread, and the response must outlive them before it is recycled
+        QPointer<CouchResponse> pointer(response);
+        QMetaObject::invokeMethod(q, [=]() {
+            QMutexLocker locker(&mutex);
+            if (!pointer)
+                return;
+            if (pointer->thread() == thread)
+                releaseResponse(pointer);
+            else if (autoDeleteResponses)
+                pointer->deleteLater();
+        }, Qt::QueuedConnection);
+        return;
+    }
+    releaseResponse(response);
+}
+
+void CouchClientPrivate::deliver(const std::function<void()> &delivery)
+{
+    if (!worker) {
+        delivery();
+        return;
+    }
+
+    deliveries += delivery;
+    if (deliveries.count() == 1)
+        QMetaObject::invokeMethod(worker, [=]() { flushDeliveries(); }, Qt::QueuedConnection);
+}
+
+void CouchClientPrivate::flushDeliveries()
+{
+    QMutexLocker locker(&mutex);
+    QVector<std::function<void()>> pending;
+    pending.swap(deliveries);
+    locker.unlock();
+
+    for (const auto &delivery : qAsConst(pending))
+        delivery();
+}
+
+void CouchClientPrivate::cacheReply(QNetworkReply *reply, CouchResponsePrivate *response, const QByteArray &data)
+{
+    if (response->request.operation() != CouchRequest::Get)
+        return;
+
+    if (isRevisionPinned(response->request) && response->batchSize <= 0 && !response->rowsDelivered) {
+        if (diskCache) {
+            QNetworkCacheMetaData metaData;
+            metaData.setUrl(diskCacheUrl(response->request.url()));
+            metaData.setSaveToDisk(true);
+            if (QIODevice *device = diskCache->prepare(metaData)) {
+                device->write(data);
+                diskCache->insert(device);
+            }
+        }
+        if (cache.maxCost() > 0)
+            cache.insert(response->request.url(), new CouchCacheEntry{QByteArray(), data}, data.size());
+        if (cache.maxCost() > 0 || diskCache)
+            ++cacheMisses;
+        return;
+    }
+
+    if (cache.maxCost() <= 0)
+        return;
+
+    ++cacheMisses;
+
+    // streamed rows are not kept around, so there is no complete body to cache
+    QByteArray etag = reply->rawHeader("ETag");
+    if (etag.isEmpty() || response->batchSize > 0 || response->rowsDelivered) {
+        cache.remove(response->request.url());
+        return;
+    }
+
+    cache.insert(response->request.url(), new CouchCacheEntry{etag, data}, data.size());
+}
+
+void CouchClientPrivate::replayResponse(CouchResponse *response, const QByteArray &data)
+{
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    QByteArray envelope = data;
+    if (r->batchSize > 0) {
+        CouchRowParser parser;
+        parser.append(data);
+        if (parser.rowCount() > 0) {
+            QPointer<CouchResponse> pointer(response);
+            const QList<CouchDocument> rows = parser.takeRows();
+            deliver([=]() {
+                if (pointer)
+                    emit pointer->rowsReceived(rows);
+            });
+        }
+        envelope = parser.envelope();
+    }
+    response->setData(envelope);
+    finishResponse(response, envelope, CouchError(), false);
+}
+
+static bool isIdempotent(const CouchRequest &request)
+{
+    // a replayed PUT without a revision fails with 409 or 412 once the
+    // first attempt has created the document or the database
+    switch (request.operation()) {
+    case CouchRequest::Get:
+        return true;
+    case CouchRequest::Put:
+    case CouchRequest::Delete:
+        return QUrlQuery(request.url()).hasQueryItem(QStringLiteral("rev"));
+    default:
+        return false;
+    }
+}
+
+static bool isTransient(QNetworkReply::NetworkError error)
+{
+    switch (error) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::ServiceUnavailableError:
+    case QNetworkReply::InternalServerError:
+    case QNetworkReply::UnknownServerError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool CouchClientPrivate::shouldRetry(QNetworkReply *reply, CouchResponsePrivate *response) const
+{
+    if (response->attempts >= retryPolicy.maxAttempts() || response->rowsDelivered)
+        return false;
+
+    if (!isIdempotent(response->request))
+        return false;
+
+    int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (code > 0)
+        return retryPolicy.statusCodes().contains(code);
+
+    return retryPolicy.retryNetworkErrors() && isTransient(reply->error());
+}
+
+bool CouchClientPrivate::shouldReauthenticate(QNetworkReply *reply, CouchResponsePrivate *response) const
+{
+    if (authentication != CouchClient::SessionAuthentication || sessionFailed)
+        return false;
+
+    if (response->reauthenticated || response->rowsDelivered)
+        return false;
+
+    return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == Couch::Unauthorized;
+}
+
+void CouchClientPrivate::retryRequest(CouchResponse *response)
+{
+    CouchResponsePrivate *r = CouchResponsePrivate::get(response);
+    r->data.clear();
+    r->rowParser.reset();
+    r->inflater.reset();
+    r->encodingChecked = false;
+
+    int delay = retryPolicy.delay(r->attempts);
+    qCDebug(lcCouchDB) << "Retrying" << r->request << "in" << delay << "ms, attempt" << r->attempts + 1;
+
+    ++retryingRequests;
+    QPointer<CouchResponse> pointer(response);
+    int generation = r->generation;
+    QTimer::singleShot(delay, context(), [=]() {
+        QMutexLocker locker(&mutex);
+        --retryingRequests;
+        if (pointer && CouchResponsePrivate::get(pointer)->generation == generation && !CouchResponsePrivate::get(pointer)->aborted)
+            enqueueRequest(pointer);
+        dispatchRequests();
+        updateRequests();
+    });
+}
+
+CouchMetricsSeries &CouchClientPrivate::metricsSeries(CouchResponsePrivate *response)
+{
+    return CouchMetricsPrivate::get(metrics)->series(response->request.operation(), response->endpoint);
+}
+
+void CouchClientPrivate::traceResponse(CouchResponsePrivate *response, const CouchError &error, bool failed)
+{
+    static const struct {
+        const char *name;
+        CouchResponse::Phase from;
+        CouchResponse::Phase to;
+    } spans[] = {
+        { "queue", CouchResponse::Enqueued, CouchResponse::Dispatched },
+        { "network", CouchResponse::Dispatched, CouchResponse::Finished },
+        { "parse", CouchResponse::Finished, CouchResponse::Parsed },
+        { "deliver", CouchResponse::Parsed, CouchResponse::Delivered },
+    };
+
+    // the phases are relative to the start of the response
+    const qint64 *timestamps = response->timestamps;
+    const qint64 base = CouchTracer::now() - response->elapsed.nsecsElapsed() / 1000;
+    const qint64 start = base + qMax<qint64>(0, timestamps[CouchResponse::Enqueued]);
+    const qint64 end = base + timestamps[CouchResponse::Delivered];
+    const int lane = tracer.lane(start, end);
+
+    const CouchRequest &request = response->request;
+    const QByteArray operation = QMetaEnum::fromType<CouchRequest::Operation>().valueToKey(request.operation());
+
+    CouchTraceEvent event;
+    event.name = operation.toUpper() + ' ' + request.url().path(QUrl::FullyEncoded).toUtf8();
+    event.timestamp = start;
+    event.duration = end - start;
+    event.lane = lane;
+    event.args.insert(QStringLiteral("url"), CouchUrl::masked(request.url()));
+    event.args.insert(QStringLiteral("status"), response->status);
+    event.args.insert(QStringLiteral("sent"), response->bytesSent);
+    event.args.insert(QStringLiteral("received"), response->bytesReceived);
+    event.args.insert(QStringLiteral("attempts"), response->attempts);
+    if (failed)
+        event.args.insert(QStringLiteral("error"), error.error());
+    tracer.add(event);
+
+    for (const auto &span : spans) {
+        if (!response->reached(span.from) || !response->reached(span.to))
+            continue;
+
+        CouchTraceEvent child;
+        child.name = span.name;
+        child.timestamp = base + timestamps[span.from];
+        child.duration = qMax<qint64>(0, timestamps[span.to] - timestamps[span.from]);
+        child.lane = lane;
+        tracer.add(child);
+    }
+}
+
+void CouchClientPrivate::updateRequests()
+{
+    Q_Q(CouchClient);
+    int queuedRequests = this->queuedRequests();
+    bool busy = activeRequests > 0 || retryingRequests > 0 || queuedRequests > 0;
+    bool wasBusy = reportedBusy.fetchAndStoreOrdered(busy);
 
-    if (--activeRequests == 0)
-        emit q->busyChanged(false);
+    if (reportedActiveRequests.fetchAndStoreOrdered(activeRequests) != activeRequests)
+        emit q->activeRequestsChanged(activeRequests);
+    if (reportedQueuedRequests.fetchAndStoreOrdered(queuedRequests) != queuedRequests)
+        emit q->queuedRequestsChanged(queuedRequests);
+    if (wasBusy != busy)
+        emit q->busyChanged(busy);
 }
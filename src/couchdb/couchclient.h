@@ -2,12 +2,15 @@
 #define COUCHCLIENT_H
 
 #include <QtCouchDB/couchglobal.h>
+#include <QtCouchDB/couchmetrics.h>
+#include <QtCouchDB/couchrequest.h>
+#include <QtCouchDB/couchretrypolicy.h>
+#include <QtCore/qfuture.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
 #include <QtCore/qurl.h>
 
 class CouchError;
-class CouchRequest;
 class CouchResponse;
 class CouchClientPrivate;
 QT_FORWARD_DECLARE_CLASS(QNetworkAccessManager)
@@ -16,9 +19,34 @@ class COUCHDB_EXPORT CouchClient : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QUrl url READ url WRITE setUrl NOTIFY urlChanged)
+    Q_PROPERTY(Authentication authentication READ authentication WRITE setAuthentication NOTIFY authenticationChanged)
+    Q_PROPERTY(int sessionTimeout READ sessionTimeout WRITE setSessionTimeout NOTIFY sessionTimeoutChanged)
     Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(int activeRequests READ activeRequests NOTIFY activeRequestsChanged)
+    Q_PROPERTY(int queuedRequests READ queuedRequests NOTIFY queuedRequestsChanged)
+    Q_PROPERTY(int maxActiveRequests READ maxActiveRequests WRITE setMaxActiveRequests NOTIFY maxActiveRequestsChanged)
+    Q_PROPERTY(bool compressionEnabled READ isCompressionEnabled WRITE setCompressionEnabled NOTIFY compressionEnabledChanged)
+    Q_PROPERTY(int compressionThreshold READ compressionThreshold WRITE setCompressionThreshold NOTIFY compressionThresholdChanged)
+    Q_PROPERTY(bool autoDeleteResponses READ autoDeleteResponses WRITE setAutoDeleteResponses NOTIFY autoDeleteResponsesChanged)
+    Q_PROPERTY(int responsePoolSize READ responsePoolSize WRITE setResponsePoolSize NOTIFY responsePoolSizeChanged)
+    Q_PROPERTY(int timeout READ timeout WRITE setTimeout NOTIFY timeoutChanged)
+    Q_PROPERTY(int connectTimeout READ connectTimeout WRITE setConnectTimeout NOTIFY connectTimeoutChanged)
+    Q_PROPERTY(CouchRetryPolicy retryPolicy READ retryPolicy WRITE setRetryPolicy NOTIFY retryPolicyChanged)
+    Q_PROPERTY(bool coalescingEnabled READ isCoalescingEnabled WRITE setCoalescingEnabled NOTIFY coalescingEnabledChanged)
+    Q_PROPERTY(int cacheSize READ cacheSize WRITE setCacheSize NOTIFY cacheSizeChanged)
+    Q_PROPERTY(QString cacheDirectory READ cacheDirectory WRITE setCacheDirectory NOTIFY cacheDirectoryChanged)
+    Q_PROPERTY(bool threaded READ isThreaded WRITE setThreaded NOTIFY threadedChanged)
+    Q_PROPERTY(int parallelDecodingThreshold READ parallelDecodingThreshold WRITE setParallelDecodingThreshold NOTIFY parallelDecodingThresholdChanged)
+    Q_PROPERTY(int slowRequestThreshold READ slowRequestThreshold WRITE setSlowRequestThreshold NOTIFY slowRequestThresholdChanged)
+    Q_PROPERTY(int traceBufferSize READ traceBufferSize WRITE setTraceBufferSize NOTIFY traceBufferSizeChanged)
 
 public:
+    enum Authentication {
+        BasicAuthentication,
+        SessionAuthentication
+    };
+    Q_ENUM(Authentication)
+
     explicit CouchClient(QObject *parent = nullptr);
     explicit CouchClient(const QUrl &url, QObject *parent = nullptr);
     ~CouchClient();
@@ -26,7 +54,75 @@ public:
     QUrl url() const;
     void setUrl(const QUrl &url);
 
+    Authentication authentication() const;
+    void setAuthentication(Authentication authentication);
+
+    int sessionTimeout() const;
+    void setSessionTimeout(int sessionTimeout);
+
     bool isBusy() const;
+    int activeRequests() const;
+    int queuedRequests() const;
+    int queuedRequests(CouchRequest::Priority priority) const;
+
+    int maxActiveRequests() const;
+    void setMaxActiveRequests(int maxActiveRequests);
+
+    bool isCompressionEnabled() const;
+    void setCompressionEnabled(bool compressionEnabled);
+
+    int compressionThreshold() const;
+    void setCompressionThreshold(int compressionThreshold);
+
+    qreal compressionRatio() const;
+
+    bool autoDeleteResponses() const;
+    void setAutoDeleteResponses(bool autoDeleteResponses);
+
+    int responsePoolSize() const;
+    void setResponsePoolSize(int responsePoolSize);
+
+    int timeout() const;
+    void setTimeout(int timeout);
+
+    int connectTimeout() const;
+    void setConnectTimeout(int connectTimeout);
+
+    CouchRetryPolicy retryPolicy() const;
+    void setRetryPolicy(const CouchRetryPolicy &retryPolicy);
+
+    bool isCoalescingEnabled() const;
+    void setCoalescingEnabled(bool coalescingEnabled);
+
+    int coalescedRequests() const;
+
+    int cacheSize() const;
+    void setCacheSize(int cacheSize);
+
+    QString cacheDirectory() const;
+    void setCacheDirectory(const QString &cacheDirectory);
+
+    int cacheHits() const;
+    int cacheMisses() const;
+    int cacheRevalidations() const;
+
+    CouchMetrics metrics() const;
+
+    bool isThreaded() const;
+    void setThreaded(bool threaded);
+
+    int parallelDecodingThreshold() const;
+    void setParallelDecodingThreshold(int parallelDecodingThreshold);
+
+    int slowRequestThreshold() const;
+    void setSlowRequestThreshold(int slowRequestThreshold);
+
+    int traceBufferSize() const;
+    void setTraceBufferSize(int traceBufferSize);
+
+    QByteArray exportTrace() const;
+
+    QFuture<QStringList> fetchDatabases();
 
     QNetworkAccessManager *networkAccessManager() const;
     void setNetworkAccessManager(QNetworkAccessManager *networkAccessManager);
@@ -38,9 +134,32 @@ public slots:
 
     CouchResponse *sendRequest(const CouchRequest &request);
 
+    void clearCache();
+    void resetMetrics();
+    void clearTrace();
+
 signals:
     void urlChanged(const QUrl &url);
+    void authenticationChanged(Authentication authentication);
+    void sessionTimeoutChanged(int sessionTimeout);
     void busyChanged(bool busy);
+    void activeRequestsChanged(int activeRequests);
+    void queuedRequestsChanged(int queuedRequests);
+    void maxActiveRequestsChanged(int maxActiveRequests);
+    void compressionEnabledChanged(bool compressionEnabled);
+    void compressionThresholdChanged(int compressionThreshold);
+    void autoDeleteResponsesChanged(bool autoDeleteResponses);
+    void responsePoolSizeChanged(int responsePoolSize);
+    void timeoutChanged(int timeout);
+    void connectTimeoutChanged(int connectTimeout);
+    void retryPolicyChanged(const CouchRetryPolicy &retryPolicy);
+    void coalescingEnabledChanged(bool coalescingEnabled);
+    void cacheSizeChanged(int cacheSize);
+    void cacheDirectoryChanged(const QString &cacheDirectory);
+    void threadedChanged(bool threaded);
+    void parallelDecodingThresholdChanged(int parallelDecodingThreshold);
+    void slowRequestThresholdChanged(int slowRequestThreshold);
+    void traceBufferSizeChanged(int traceBufferSize);
 
     void databasesListed(const QStringList &databases);
     void databaseCreated(const QString &database);
@@ -0,0 +1,146 @@
+#ifndef COUCHCLIENT_P_H
+#define COUCHCLIENT_P_H
+
+#include <QtCouchDB/couchclient.h>
+#include <QtCouchDB/coucherror.h>
+#include <QtCouchDB/couchmetrics.h>
+#include <QtCouchDB/couchrequest.h>
+#include <QtCouchDB/couchresponse.h>
+#include <QtCouchDB/couchretrypolicy.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qqueue.h>
+#include <QtCore/qurl.h>
+#include <QtCore/qvector.h>
+
+#include <functional>
+
+#include "couchtrace_p.h"
+
+class CouchResponsePrivate;
+struct CouchMetricsSeries;
+QT_FORWARD_DECLARE_CLASS(QNetworkAccessManager)
+QT_FORWARD_DECLARE_CLASS(QNetworkDiskCache)
+QT_FORWARD_DECLARE_CLASS(QNetworkReply)
+QT_FORWARD_DECLARE_CLASS(QThread)
+
+static const int PriorityCount = CouchRequest::Bulk + 1;
+static const int MaxSkippedDispatches = 8;
+static const int DefaultSessionTimeout = 600;
+
+struct CouchCacheEntry
+{
+    QByteArray etag;
+    QByteArray data;
+};
+
+class CouchClientPrivate
+{
+    Q_DECLARE_PUBLIC(CouchClient)
+
+public:
+    static CouchClientPrivate *get(CouchClient *client) { return client->d_func(); }
+
+    CouchResponse *sendRequest(const CouchRequest &request,
+                               const std::function<void(const QByteArray &)> &onReceived,
+                               const std::function<void(const CouchError &)> &onError);
+
+    int queuedRequests() const;
+    QObject *context() const;
+    bool ownsNetworkAccessManager() const;
+    void connectNetworkAccessManager();
+    CouchResponse *createResponse(const CouchRequest &request);
+    void releaseResponse(CouchResponse *response);
+    void updateAuthorization();
+    bool needsSession() const;
+    void startSession();
+    void sessionFinished(QNetworkReply *reply);
+    int nextPriority();
+    CouchResponse *coalescingResponse(const CouchRequest &request) const;
+    bool replayFromCache(CouchResponse *response);
+    void releaseFollowers(CouchResponse *response);
+    void abortRequest(CouchResponse *response, const CouchError &error);
+    void dropRequest(CouchResponse *response);
+    void startTimeout(CouchResponse *response);
+    void enqueueRequest(CouchResponse *response);
+    void scheduleRequests();
+    void dispatchRequests();
+    void startRequest(CouchResponse *response);
+    QByteArray readReply(QNetworkReply *reply, CouchResponsePrivate *response);
+    void readyRead(QNetworkReply *reply);
+    void queryFinished(QNetworkReply *reply);
+    void finishResponse(CouchResponse *response, const QByteArray &data, const CouchError &error, bool failed);
+    void deliverResponse(CouchResponse *response, const QByteArray &data, const CouchError &error, bool failed);
+    void completeResponse(CouchResponse *response, const CouchError &error, bool failed);
+    void deliver(const std::function<void()> &delivery);
+    void flushDeliveries();
+    void replayResponse(CouchResponse *response, const QByteArray &data);
+    void cacheReply(QNetworkReply *reply, CouchResponsePrivate *response, const QByteArray &data);
+    bool shouldRetry(QNetworkReply *reply, CouchResponsePrivate *response) const;
+    bool shouldReauthenticate(QNetworkReply *reply, CouchResponsePrivate *response) const;
+    void retryRequest(CouchResponse *response);
+    void updateRequests();
+    CouchMetricsSeries &metricsSeries(CouchResponsePrivate *response);
+    void traceResponse(CouchResponsePrivate *response, const CouchError &error, bool failed);
+
+    QUrl url;
+    CouchClient::Authentication authentication = CouchClient::BasicAuthentication;
+    QByteArray authorization;
+    int sessionTimeout = DefaultSessionTimeout;
+    bool sessionFailed = false;
+    QElapsedTimer sessionTimer;
+    QNetworkReply *sessionReply = nullptr;
+    int activeRequests = 0;
+    int maxActiveRequests = 0;
+    int retryingRequests = 0;
+    bool compressionEnabled = false;
+    int compressionThreshold = 0;
+    qint64 compressedBytes = 0;
+    qint64 uncompressedBytes = 0;
+    bool autoDeleteResponses = true;
+    int responsePoolSize = 0;
+    QVector<CouchResponse *> responsePool;
+    int timeout = 0;
+    int connectTimeout = 0;
+    int parallelDecodingThreshold = 0;
+    int slowRequestThreshold = 0;
+    CouchTracer tracer;
+    CouchRetryPolicy retryPolicy;
+    bool coalescingEnabled = false;
+    int coalescedRequests = 0;
+    int cacheHits = 0;
+    int cacheMisses = 0;
+    int cacheRevalidations = 0;
+    CouchMetrics metrics;
+    QAtomicInt reportedActiveRequests = 0;
+    QAtomicInt reportedQueuedRequests = 0;
+    QAtomicInt reportedBusy = 0;
+    int skippedDispatches[PriorityCount] = {};
+    QQueue<QPointer<CouchResponse>> queues[PriorityCount];
+    QHash<QUrl, QPointer<CouchResponse>> pendingGets;
+    QCache<QUrl, CouchCacheEntry> cache;
+    QNetworkDiskCache *diskCache = nullptr;
+    CouchClient *q_ptr = nullptr;
+    QNetworkAccessManager *networkAccessManager = nullptr;
+    QMetaObject::Connection finishedConnection;
+    // the worker lives in the thread that owns the network access manager and
+    // the responses in threaded mode, the mutex guards everything above
+    QThread *thread = nullptr;
+    QObject *worker = nullptr;
+    bool dispatchScheduled = false;
+    // the signals of the responses are emitted by the worker once the mutex
+    // is released, so that slow receivers do not hold up the other threads
+    QVector<std::function<void()>> deliveries;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    mutable QRecursiveMutex mutex;
+#else
+    mutable QMutex mutex{QMutex::Recursive};
+#endif
+};
+
+#endif // COUCHCLIENT_P_H
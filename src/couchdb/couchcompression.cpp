@@ -0,0 +1,110 @@
+#include "couchcompression_p.h"
+
+#include <cstring>
+#include <zlib.h>
+
+static const int ChunkSize = 16 * 1024;
+
+struct CouchInflater::Stream : public z_stream
+{
+};
+
+bool CouchCompression::isSupported(const QByteArray &encoding)
+{
+    QByteArray value = encoding.trimmed().toLower();
+    return value == "gzip" || value == "x-gzip" || value == "deflate";
+}
+
+QByteArray CouchCompression::gzip(const QByteArray &data)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    // MAX_WBITS + 16 writes a gzip header and trailer instead of a zlib one
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return QByteArray();
+
+    QByteArray compressed;
+    compressed.resize(int(deflateBound(&stream, uLong(data.size()))));
+
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = uInt(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+    stream.avail_out = uInt(compressed.size());
+
+    int ret = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    if (ret != Z_STREAM_END)
+        return QByteArray();
+
+    compressed.resize(int(stream.total_out));
+    return compressed;
+}
+
+CouchInflater::CouchInflater()
+    : m_stream(new Stream)
+{
+    // MAX_WBITS + 32 detects both gzip and zlib headers
+    init(MAX_WBITS + 32);
+}
+
+CouchInflater::~CouchInflater()
+{
+    inflateEnd(m_stream);
+    delete m_stream;
+}
+
+void CouchInflater::init(int windowBits)
+{
+    memset(static_cast<z_stream *>(m_stream), 0, sizeof(z_stream));
+    m_error = inflateInit2(m_stream, windowBits) != Z_OK;
+}
+
+bool CouchInflater::hasError() const
+{
+    return m_error;
+}
+
+bool CouchInflater::decode(const QByteArray &data, QByteArray *decoded)
+{
+    if (m_error)
+        return false;
+    if (m_finished || data.isEmpty())
+        return true;
+
+    m_stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    m_stream->avail_in = uInt(data.size());
+
+    do {
+        int offset = decoded->size();
+        decoded->resize(offset + ChunkSize);
+        m_stream->next_out = reinterpret_cast<Bytef *>(decoded->data() + offset);
+        m_stream->avail_out = ChunkSize;
+
+        int ret = ::inflate(m_stream, Z_NO_FLUSH);
+        decoded->resize(offset + ChunkSize - int(m_stream->avail_out));
+
+        if (ret == Z_STREAM_END) {
+            m_finished = true;
+            break;
+        }
+
+        if (ret == Z_DATA_ERROR && !m_raw && m_stream->total_out == 0) {
+            // some servers send raw deflate data without the zlib wrapper
+            inflateEnd(m_stream);
+            init(-MAX_WBITS);
+            m_raw = true;
+            return !m_error && decode(data, decoded);
+        }
+
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            m_error = true;
+            return false;
+        }
+
+        if (ret == Z_BUF_ERROR)
+            break;
+    } while (m_stream->avail_out == 0);
+
+    return true;
+}
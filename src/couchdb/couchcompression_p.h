@@ -0,0 +1,33 @@
+#ifndef COUCHCOMPRESSION_P_H
+#define COUCHCOMPRESSION_P_H
+
+#include <QtCore/qbytearray.h>
+
+class CouchCompression
+{
+public:
+    static bool isSupported(const QByteArray &encoding);
+    static QByteArray gzip(const QByteArray &data);
+};
+
+class CouchInflater
+{
+public:
+    CouchInflater();
+    ~CouchInflater();
+
+    bool hasError() const;
+    bool decode(const QByteArray &data, QByteArray *decoded);
+
+private:
+    Q_DISABLE_COPY(CouchInflater)
+    void init(int windowBits);
+
+    struct Stream;
+    Stream *m_stream = nullptr;
+    bool m_raw = false;
+    bool m_error = false;
+    bool m_finished = false;
+};
+
+#endif // COUCHCOMPRESSION_P_H
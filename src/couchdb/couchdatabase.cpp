@@ -1,7 +1,13 @@
 ﻿#include "couchdatabase.h"
 #include "couchclient.h"
+#include "couchdecoder_p.h"
+#include "couchfuture_p.h"
 #include "couchrequest.h"
 #include "couchresponse.h"
+#include "couchresponse_p.h"
+
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qpointer.h>
 
 class CouchDatabasePrivate
 {
@@ -19,6 +25,7 @@ public:
 
     CouchDatabase *q_ptr = nullptr;
     QString name;
+    int batchSize = 0;
     CouchClient *client = nullptr;
 };
 
@@ -89,6 +96,45 @@ void CouchDatabase::setClient(CouchClient *client)
     emit clientChanged(client);
 }
 
+int CouchDatabase::batchSize() const
+{
+    Q_D(const CouchDatabase);
+    return d->batchSize;
+}
+
+void CouchDatabase::setBatchSize(int batchSize)
+{
+    Q_D(CouchDatabase);
+    batchSize = qMax(0, batchSize);
+    if (d->batchSize == batchSize)
+        return;
+
+    d->batchSize = batchSize;
+    emit batchSizeChanged(batchSize);
+}
+
+QFuture<QList<CouchDocument>> CouchDatabase::fetchDocuments(const CouchQuery &query)
+{
+    Q_D(CouchDatabase);
+    QPointer<CouchDatabase> database(this);
+    return CouchFuture::fetch<QList<CouchDocument>>(d->client, Couch::queryDocuments(url(), query), &Couch::toDocumentList,
+                                                    [=](const CouchError &error) {
+        if (database)
+            emit database->errorOccurred(error);
+    });
+}
+
+QFuture<CouchDocument> CouchDatabase::fetchDocument(const CouchDocument &document)
+{
+    Q_D(CouchDatabase);
+    QPointer<CouchDatabase> database(this);
+    return CouchFuture::fetch<CouchDocument>(d->client, Couch::getDocument(url(), document), &Couch::toDocument,
+                                             [=](const CouchError &error) {
+        if (database)
+            emit database->errorOccurred(error);
+    });
+}
+
 CouchResponse *CouchDatabase::listDesignDocuments()
 {
     Q_D(CouchDatabase);
@@ -161,8 +207,39 @@ CouchResponse *CouchDatabase::queryDocuments(const CouchQuery &query)
     if (!response)
         return nullptr;
 
+    if (d->batchSize > 0) {
+        response->setBatchSize(d->batchSize);
+        connect(response, &CouchResponse::rowsReceived, this, &CouchDatabase::rowsReceived);
+        return d->response(response);
+    }
+
+    int threshold = d->client->parallelDecodingThreshold();
     connect(response, &CouchResponse::received, [=](const QByteArray &data) {
-        emit documentsListed(Couch::toDocumentList(data));
+        // only decode the forms that are listened to
+        if (isSignalConnected(QMetaMethod::fromSignal(&CouchDatabase::documentSetListed))) {
+            CouchRowSet documents = CouchRowSet::fromJson(data);
+            CouchResponsePrivate::get(response)->mark(CouchResponse::Parsed);
+            emit documentSetListed(documents);
+        }
+        if (!isSignalConnected(QMetaMethod::fromSignal(&CouchDatabase::documentsListed)))
+            return;
+
+        if (threshold > 0 && data.size() >= threshold) {
+            // parsed and delivered once the rows are decoded
+            QPointer<CouchResponse> pointer(response);
+            CouchResponsePrivate::get(response)->deferDelivery();
+            CouchDecoder::decodeDocumentList(data, this, [=](const QList<CouchDocument> &documents) {
+                if (pointer)
+                    CouchResponsePrivate::get(pointer)->mark(CouchResponse::Parsed);
+                emit documentsListed(documents);
+                if (pointer)
+                    CouchResponsePrivate::completeDelivery(pointer);
+            });
+            return;
+        }
+        QList<CouchDocument> documents = Couch::toDocumentList(data);
+        CouchResponsePrivate::get(response)->mark(CouchResponse::Parsed);
+        emit documentsListed(documents);
     });
     return d->response(response);
 }
@@ -5,6 +5,7 @@
 #include <QtCouchDB/couch.h>
 #include <QtCouchDB/couchdocument.h>
 #include <QtCouchDB/coucherror.h>
+#include <QtCore/qfuture.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
 
@@ -19,6 +20,7 @@ class COUCHDB_EXPORT CouchDatabase : public QObject
     Q_PROPERTY(QUrl url READ url NOTIFY urlChanged)
     Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
     Q_PROPERTY(CouchClient *client READ client WRITE setClient NOTIFY clientChanged)
+    Q_PROPERTY(int batchSize READ batchSize WRITE setBatchSize NOTIFY batchSizeChanged)
 
 public:
     explicit CouchDatabase(QObject *parent = nullptr);
@@ -33,6 +35,12 @@ public:
     CouchClient *client() const;
     void setClient(CouchClient *client);
 
+    int batchSize() const;
+    void setBatchSize(int batchSize);
+
+    QFuture<QList<CouchDocument>> fetchDocuments(const CouchQuery &query);
+    QFuture<CouchDocument> fetchDocument(const CouchDocument &document);
+
 public slots:
     CouchResponse *listDesignDocuments();
     CouchResponse *createDesignDocument(const QString &designDocument);
@@ -54,6 +62,7 @@ signals:
     void urlChanged(const QUrl &url);
     void nameChanged(const QString &name);
     void clientChanged(CouchClient *client);
+    void batchSizeChanged(int batchSize);
     void errorOccurred(const CouchError &error);
 
     void designDocumentsListed(const QStringList &designDocuments);
@@ -61,6 +70,8 @@ signals:
     void designDocumentDeleted(const QString &designDocument);
 
     void documentsListed(const QList<CouchDocument> &documents);
+    void documentSetListed(const CouchRowSet &documents);
+    void rowsReceived(const QList<CouchDocument> &rows);
     void documentCreated(const CouchDocument &document);
     void documentReceived(const CouchDocument &document);
     void documentUpdated(const CouchDocument &document);
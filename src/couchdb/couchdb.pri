@@ -3,26 +3,49 @@ DEPENDPATH += $$PWD
 
 HEADERS += \
     $$PWD/couch.h \
+    $$PWD/couchawait.h \
     $$PWD/couchclient.h \
+    $$PWD/couchclient_p.h \
+    $$PWD/couchcompression_p.h \
     $$PWD/couchdatabase.h \
+    $$PWD/couchdecoder_p.h \
     $$PWD/couchdesigndocument.h \
     $$PWD/couchdocument.h \
+    $$PWD/couchdocument_p.h \
     $$PWD/coucherror.h \
+    $$PWD/couchfuture_p.h \
     $$PWD/couchglobal.h \
+    $$PWD/couchjson_p.h \
+    $$PWD/couchmetrics.h \
+    $$PWD/couchmetrics_p.h \
     $$PWD/couchquery.h \
     $$PWD/couchrequest.h \
     $$PWD/couchresponse.h \
+    $$PWD/couchresponse_p.h \
+    $$PWD/couchretrypolicy.h \
+    $$PWD/couchrowparser_p.h \
+    $$PWD/couchrowset.h \
+    $$PWD/couchtrace_p.h \
     $$PWD/couchurl_p.h \
     $$PWD/couchview.h
 
 SOURCES += \
     $$PWD/couch.cpp \
+    $$PWD/couchawait.cpp \
     $$PWD/couchclient.cpp \
+    $$PWD/couchcompression.cpp \
     $$PWD/couchdatabase.cpp \
+    $$PWD/couchdecoder.cpp \
     $$PWD/couchdesigndocument.cpp \
     $$PWD/couchdocument.cpp \
     $$PWD/coucherror.cpp \
+    $$PWD/couchjson.cpp \
+    $$PWD/couchmetrics.cpp \
     $$PWD/couchquery.cpp \
     $$PWD/couchrequest.cpp \
     $$PWD/couchresponse.cpp \
+    $$PWD/couchretrypolicy.cpp \
+    $$PWD/couchrowparser.cpp \
+    $$PWD/couchrowset.cpp \
+    $$PWD/couchtrace.cpp \
     $$PWD/couchview.cpp
@@ -2,6 +2,12 @@ TARGET = QtCouchDB
 MODULE = couchdb
 
 QT = core network
+QT_PRIVATE += core-private
+
+qtConfig(system-zlib): \
+    QMAKE_USE_PRIVATE += zlib
+else: \
+    QT_PRIVATE += zlib-private
 
 include(couchdb.pri)
 
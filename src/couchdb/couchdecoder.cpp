@@ -0,0 +1,195 @@
+#include "couchdecoder_p.h"
+#include "couchdocument_p.h"
+#include "couchjson_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qfutureinterface.h>
+#include <QtCore/qfuturewatcher.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qthreadpool.h>
+
+// fewer rows are not worth the hand-off to another thread
+static const int MinRowsPerTask = 64;
+
+QVector<CouchRowSpan> CouchDecoder::rowSpans(const QByteArray &data, const MemberCallback &onMember)
+{
+    QVector<CouchRowSpan> spans;
+    const char *json = data.constData();
+    const int size = data.size();
+
+    QByteArray string;
+    QByteArray key;
+    int depth = 0;
+    int stringStart = -1;
+    int rowStart = -1;
+    int valueStart = -1;
+    bool inRows = false;
+    bool inString = false;
+
+    auto reportMember = [&](int end) {
+        if (onMember && valueStart != -1)
+            onMember(key, CouchJsonSpan(valueStart, end - valueStart));
+        valueStart = -1;
+    };
+
+    // only the structural characters matter, the scanner skips all others
+    CouchJsonScanner scanner(json, 0, size);
+    for (int pos = scanner.next(); pos != -1; pos = scanner.next()) {
+        const char c = json[pos];
+        if (inString) {
+            if (c == '\\') {
+                scanner.skip(pos + 1);
+            } else if (c == '"') {
+                inString = false;
+                if (!inRows && depth == 1)
+                    string = QByteArray::fromRawData(json + stringStart, pos - stringStart);
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            inString = true;
+            stringStart = pos + 1;
+            break;
+        case ':':
+            if (!inRows && depth == 1) {
+                key = string;
+                valueStart = pos + 1;
+            }
+            break;
+        case ',':
+            if (!inRows && depth == 1) {
+                reportMember(pos);
+                key.clear();
+            }
+            break;
+        case '{':
+        case '[':
+            ++depth;
+            if (!inRows && depth == 2 && c == '[' && key == "rows") {
+                inRows = true;
+                valueStart = -1;
+            } else if (inRows && depth == 3) {
+                rowStart = pos;
+            }
+            break;
+        case '}':
+        case ']':
+            if (inRows && depth == 3 && rowStart != -1) {
+                spans += CouchRowSpan{rowStart, pos - rowStart + 1};
+                rowStart = -1;
+            } else if (!inRows && depth == 1) {
+                reportMember(pos);
+            }
+            --depth;
+            if (inRows && depth == 1) {
+                // the members after the rows are only scanned for the callback
+                if (!onMember)
+                    return spans;
+                inRows = false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return spans;
+}
+
+struct CouchDecodeState
+{
+    QByteArray data;
+    QVector<CouchRowSpan> spans;
+    QVector<QList<CouchDocument>> chunks;
+    QAtomicInt remaining;
+    QFutureInterface<QList<CouchDocument>> promise;
+};
+
+class CouchDecodeTask : public QRunnable
+{
+public:
+    CouchDecodeTask(const QSharedPointer<CouchDecodeState> &state, int chunk, int first, int last)
+        : m_state(state), m_chunk(chunk), m_first(first), m_last(last) { }
+
+    void run() override
+    {
+        QList<CouchDocument> rows;
+        rows.reserve(m_last - m_first);
+        for (int i = m_first; i < m_last; ++i) {
+            const CouchRowSpan &span = m_state->spans.at(i);
+            const CouchDocument document = CouchDocumentPrivate::fromRow(m_state->data, span.start, span.length);
+            // decode the content here instead of in the receiver's thread
+            document.content();
+            rows += document;
+        }
+        m_state->chunks[m_chunk] = rows;
+
+        // the last chunk to finish puts the rows back in order
+        if (!m_state->remaining.deref()) {
+            QList<CouchDocument> documents;
+            documents.reserve(m_state->spans.count());
+            for (const QList<CouchDocument> &chunk : qAsConst(m_state->chunks))
+                documents += chunk;
+            m_state->promise.reportFinished(&documents);
+        }
+    }
+
+private:
+    QSharedPointer<CouchDecodeState> m_state;
+    int m_chunk;
+    int m_first;
+    int m_last;
+};
+
+class CouchScanTask : public QRunnable
+{
+public:
+    CouchScanTask(const QSharedPointer<CouchDecodeState> &state, QThreadPool *pool)
+        : m_state(state), m_pool(pool) { }
+
+    void run() override
+    {
+        // the rows are split up only once the whole response has been scanned,
+        // which is done here too rather than in the thread that received it
+        m_state->spans = CouchDecoder::rowSpans(m_state->data);
+        int count = m_state->spans.count();
+        int tasks = qBound(1, count / MinRowsPerTask, qMax(1, m_pool->maxThreadCount()));
+        m_state->chunks.resize(tasks);
+        m_state->remaining.storeRelease(tasks);
+
+        for (int i = 1; i < tasks; ++i)
+            m_pool->start(new CouchDecodeTask(m_state, i, count * i / tasks, count * (i + 1) / tasks));
+
+        // the first chunk is decoded right away in this thread
+        CouchDecodeTask(m_state, 0, 0, count / tasks).run();
+    }
+
+private:
+    QSharedPointer<CouchDecodeState> m_state;
+    QThreadPool *m_pool;
+};
+
+void CouchDecoder::decodeDocumentList(const QByteArray &data, QObject *receiver,
+                                      const std::function<void(const QList<CouchDocument> &)> &onDecoded)
+{
+    QThreadPool *pool = QThreadPool::globalInstance();
+
+    QSharedPointer<CouchDecodeState> state(new CouchDecodeState);
+    state->data = data;
+    state->promise.reportStarted();
+
+    // the watcher is moved along with its pending events to the receiver,
+    // which takes it down if it is destroyed before the rows are decoded
+    QFutureWatcher<QList<CouchDocument>> *watcher = new QFutureWatcher<QList<CouchDocument>>;
+    QObject::connect(watcher, &QFutureWatcherBase::finished, receiver, [=]() {
+        onDecoded(watcher->result());
+        watcher->deleteLater();
+    });
+    QObject::connect(receiver, &QObject::destroyed, watcher, &QObject::deleteLater);
+    watcher->setFuture(state->promise.future());
+    watcher->moveToThread(receiver->thread());
+
+    pool->start(new CouchScanTask(state, pool));
+}
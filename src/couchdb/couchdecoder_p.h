@@ -0,0 +1,36 @@
+#ifndef COUCHDECODER_P_H
+#define COUCHDECODER_P_H
+
+#include <QtCouchDB/couchdocument.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qvector.h>
+
+#include <functional>
+
+#include "couchjson_p.h"
+
+QT_FORWARD_DECLARE_CLASS(QObject)
+
+struct CouchRowSpan
+{
+    int start;
+    int length;
+};
+
+class COUCHDB_EXPORT CouchDecoder
+{
+public:
+    typedef std::function<void(const QByteArray &key, const CouchJsonSpan &value)> MemberCallback;
+
+    // the spans of the rows, and in the same pass the raw values of the other
+    // top-level members, e.g. total_rows and offset
+    static QVector<CouchRowSpan> rowSpans(const QByteArray &data, const MemberCallback &onMember = nullptr);
+
+    // scans and decodes the rows in parallel on the global thread pool and calls
+    // onDecoded in the thread of the receiver, unless it is gone by then
+    static void decodeDocumentList(const QByteArray &data, QObject *receiver,
+                                   const std::function<void(const QList<CouchDocument> &)> &onDecoded);
+};
+
+#endif // COUCHDECODER_P_H
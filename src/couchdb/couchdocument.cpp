@@ -1,15 +1,9 @@
 #include "couchdocument.h"
+#include "couchdocument_p.h"
 
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
-
-class CouchDocumentPrivate : public QSharedData
-{
-public:
-    QString id;
-    QString revision;
-    QByteArray content;
-};
+#include <QtCore/qthread.h>
 
 CouchDocument::CouchDocument(const QString &id, const QString &revision) :
     d_ptr(new CouchDocumentPrivate)
@@ -19,6 +13,11 @@ CouchDocument::CouchDocument(const QString &id, const QString &revision) :
     d->revision = revision;
 }
 
+CouchDocument::CouchDocument(CouchDocumentPrivate *d) :
+    d_ptr(d)
+{
+}
+
 CouchDocument::~CouchDocument()
 {
 }
@@ -41,15 +40,15 @@ CouchDocument &CouchDocument::operator=(const QString &id)
     d_ptr->id = id;
     d_ptr->revision = QString();
     d_ptr->content = QByteArray();
+    d_ptr->clearSource();
     return *this;
 }
 
 bool CouchDocument::operator==(const CouchDocument &other) const
 {
-    Q_D(const CouchDocument);
-    return d_ptr == other.d_ptr || (d->id == other.id() &&
-                                    d->revision == other.revision() &&
-                                    d->content == other.content());
+    return d_ptr == other.d_ptr || (id() == other.id() &&
+                                    revision() == other.revision() &&
+                                    content() == other.content());
 }
 
 bool CouchDocument::operator!=(const CouchDocument &other) const
@@ -60,19 +59,19 @@ bool CouchDocument::operator!=(const CouchDocument &other) const
 QString CouchDocument::id() const
 {
     Q_D(const CouchDocument);
-    return d->id;
+    return d->idValue();
 }
 
 QString CouchDocument::revision() const
 {
     Q_D(const CouchDocument);
-    return d->revision;
+    return d->revisionValue();
 }
 
 QByteArray CouchDocument::content() const
 {
     Q_D(const CouchDocument);
-    return d->content;
+    return d->contentValue();
 }
 
 CouchDocument CouchDocument::withRevision(const QString &revision) const
@@ -80,6 +79,7 @@ CouchDocument CouchDocument::withRevision(const QString &revision) const
     CouchDocument copy(*this);
     copy.d_ptr.detach();
     copy.d_ptr->revision = revision;
+    copy.d_ptr->revisionSpan = CouchJsonSpan();
     return copy;
 }
 
@@ -88,16 +88,16 @@ CouchDocument CouchDocument::withContent(const QByteArray &content) const
     CouchDocument copy(*this);
     copy.d_ptr.detach();
     copy.d_ptr->content = content;
+    copy.d_ptr->contentState.storeRelease(CouchDocumentPrivate::ContentDecoded);
     return copy;
 }
 
 QJsonObject CouchDocument::toJson() const
 {
-    Q_D(const CouchDocument);
     QJsonObject json;
-    json.insert(QStringLiteral("id"), d->id);
-    json.insert(QStringLiteral("rev"), d->revision);
-    json.insert(QStringLiteral("doc"), QJsonDocument::fromJson(d->content).object());
+    json.insert(QStringLiteral("id"), id());
+    json.insert(QStringLiteral("rev"), revision());
+    json.insert(QStringLiteral("doc"), QJsonDocument::fromJson(content()).object());
     return json;
 }
 
@@ -144,6 +144,97 @@ CouchDocument CouchDocument::fromJson(const QJsonObject &json)
     return CouchDocument(id, revision).withContent(content);
 }
 
+CouchDocumentPrivate::CouchDocumentPrivate(const CouchDocumentPrivate &other)
+    : QSharedData(other),
+      id(other.id),
+      revision(other.revision),
+      source(other.source),
+      row(other.row),
+      idSpan(other.idSpan),
+      revisionSpan(other.revisionSpan)
+{
+    // a copy taken while the other one is still decoding decodes on its own
+    if (other.contentState.loadAcquire() == ContentDecoded)
+        content = other.content;
+    else
+        contentState.storeRelease(ContentLazy);
+}
+
+CouchDocument CouchDocumentPrivate::fromRow(const QByteArray &source, int start, int length)
+{
+    const CouchJsonSpan row(start, length);
+    const CouchJsonMembers members = CouchJson::members(source.constData(), row);
+    return fromRow(source, row, CouchJson::findId(source.constData(), members),
+                   CouchJson::findRevision(source.constData(), members));
+}
+
+CouchDocument CouchDocumentPrivate::fromRow(const QByteArray &source, const CouchJsonSpan &row,
+                                            const CouchJsonSpan &id, const CouchJsonSpan &revision)
+{
+    CouchDocumentPrivate *d = new CouchDocumentPrivate;
+    d->source = source;
+    d->row = row;
+    d->idSpan = id;
+    d->revisionSpan = revision;
+    d->contentState.storeRelease(ContentLazy);
+    return CouchDocument(d);
+}
+
+QString CouchDocumentPrivate::idValue() const
+{
+    if (idSpan.isValid())
+        return CouchJson::toString(source, idSpan);
+    return id;
+}
+
+QString CouchDocumentPrivate::revisionValue() const
+{
+    if (revisionSpan.isValid())
+        return CouchJson::toString(source, revisionSpan);
+    return revision;
+}
+
+QByteArray CouchDocumentPrivate::contentValue() const
+{
+    if (contentState.loadAcquire() == ContentDecoded)
+        return content;
+
+    // the content is normalized the same way as fromJson() does it, and only
+    // once no matter how many threads share the document
+    if (contentState.testAndSetAcquire(ContentLazy, ContentDecoding)) {
+        QByteArray json = QByteArray::fromRawData(source.constData() + row.start, row.length);
+        content = CouchDocument::fromJson(QJsonDocument::fromJson(json).object()).content();
+        contentState.storeRelease(ContentDecoded);
+    } else {
+        while (contentState.loadAcquire() != ContentDecoded)
+            QThread::yieldCurrentThread();
+    }
+    return content;
+}
+
+QByteArray CouchDocumentPrivate::rawContent(const CouchDocument &document)
+{
+    const CouchDocumentPrivate *d = document.d_func();
+    if (d->contentState.loadAcquire() == ContentDecoded)
+        return d->content;
+
+    // only the order and the spacing of its members differ from contentValue()
+    const char *json = d->source.constData();
+    const CouchJsonMembers members = CouchJson::members(json, d->row);
+    if (members.doc.isValid() && json[members.doc.start] == '{' && (members._id.isValid() || members.id.isValid()))
+        return QByteArray::fromRawData(json + members.doc.start, members.doc.length);
+    return d->contentValue();
+}
+
+void CouchDocumentPrivate::clearSource()
+{
+    source.clear();
+    row = CouchJsonSpan();
+    idSpan = CouchJsonSpan();
+    revisionSpan = CouchJsonSpan();
+    contentState.storeRelease(ContentDecoded);
+}
+
 QDebug operator<<(QDebug debug, const CouchDocument &document)
 {
     QDebugStateSaver saver(debug);
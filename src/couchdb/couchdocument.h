@@ -40,6 +40,9 @@ public:
     static CouchDocument fromJson(const QJsonObject &json);
 
 private:
+    explicit CouchDocument(CouchDocumentPrivate *d);
+    friend class CouchDocumentPrivate;
+
     Q_DECLARE_PRIVATE(CouchDocument)
     QExplicitlySharedDataPointer<CouchDocumentPrivate> d_ptr;
 };
@@ -0,0 +1,48 @@
+#ifndef COUCHDOCUMENT_P_H
+#define COUCHDOCUMENT_P_H
+
+#include <QtCouchDB/couchdocument.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstring.h>
+
+#include "couchjson_p.h"
+
+class CouchDocumentPrivate : public QSharedData
+{
+public:
+    CouchDocumentPrivate() = default;
+    CouchDocumentPrivate(const CouchDocumentPrivate &other);
+
+    // a lazy document that refers to a row in the shared response buffer,
+    // and only decodes the id, revision and content when accessed
+    static CouchDocument fromRow(const QByteArray &source, int start, int length);
+    static CouchDocument fromRow(const QByteArray &source, const CouchJsonSpan &row,
+                                 const CouchJsonSpan &id, const CouchJsonSpan &revision);
+
+    QString idValue() const;
+    QString revisionValue() const;
+    QByteArray contentValue() const;
+
+    // the content as it is in the source when it does not need decoding,
+    // e.g. the doc of a row, which can be spliced into a request as is
+    static QByteArray rawContent(const CouchDocument &document);
+    void clearSource();
+
+    QString id;
+    QString revision;
+    mutable QByteArray content;
+
+    QByteArray source;
+    CouchJsonSpan row;
+    CouchJsonSpan idSpan;
+    CouchJsonSpan revisionSpan;
+
+    // the content of a lazy document is decoded once by whichever thread
+    // gets to it first, the others wait for it to be published
+    enum ContentState { ContentDecoded, ContentLazy, ContentDecoding };
+    mutable QAtomicInt contentState{ContentDecoded};
+};
+
+#endif // COUCHDOCUMENT_P_H
@@ -71,6 +71,12 @@ QString CouchError::reason() const
     return d->reason;
 }
 
+bool CouchError::isTimeout() const
+{
+    Q_D(const CouchError);
+    return d->error == QLatin1String("TimeoutError");
+}
+
 CouchError CouchError::withCode(int code) const
 {
     CouchError copy(*this);
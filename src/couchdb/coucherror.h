@@ -19,6 +19,7 @@ class COUCHDB_EXPORT CouchError
     Q_PROPERTY(int code READ code)
     Q_PROPERTY(QString error READ error)
     Q_PROPERTY(QString reason READ reason)
+    Q_PROPERTY(bool timeout READ isTimeout)
 
 public:
     CouchError(const QString &error = QString(), const QString &reason = QString());
@@ -35,6 +36,8 @@ public:
     QString error() const;
     QString reason() const;
 
+    bool isTimeout() const;
+
     CouchError withCode(int code) const;
 
     static CouchError fromJson(const QJsonObject &json);
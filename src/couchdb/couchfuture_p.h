@@ -0,0 +1,47 @@
+#ifndef COUCHFUTURE_P_H
+#define COUCHFUTURE_P_H
+
+#include <QtCouchDB/couchclient.h>
+#include <QtCouchDB/coucherror.h>
+#include <QtCouchDB/couchrequest.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qfutureinterface.h>
+
+#include "couchclient_p.h"
+
+#include <functional>
+
+namespace CouchFuture
+{
+    // completes the future straight from the client, without any signal connections
+    template <typename T, typename Parser>
+    QFuture<T> fetch(CouchClient *client, const CouchRequest &request, Parser parse,
+                     const std::function<void(const CouchError &)> &onError = nullptr)
+    {
+        QFutureInterface<T> promise;
+        promise.reportStarted();
+
+        CouchResponse *response = nullptr;
+        if (client) {
+            response = CouchClientPrivate::get(client)->sendRequest(request,
+                [=](const QByteArray &data) mutable {
+                    const T result = parse(data);
+                    promise.reportFinished(&result);
+                },
+                [=](const CouchError &error) mutable {
+                    if (onError)
+                        onError(error);
+                    promise.reportCanceled();
+                    promise.reportFinished();
+                });
+        }
+
+        if (!response) {
+            promise.reportCanceled();
+            promise.reportFinished();
+        }
+        return promise.future();
+    }
+}
+
+#endif // COUCHFUTURE_P_H
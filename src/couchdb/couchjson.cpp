@@ -0,0 +1,309 @@
+#include "couchjson_p.h"
+
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/private/qsimd_p.h>
+
+#include <cstring>
+
+static inline bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static int skipWhitespace(const char *json, int pos, int end)
+{
+    while (pos < end && isWhitespace(json[pos]))
+        ++pos;
+    return pos;
+}
+
+static inline bool isStructural(char c)
+{
+    switch (c) {
+    case '"':
+    case '\\':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+        return true;
+    default:
+        return false;
+    }
+}
+
+quint64 CouchJsonScanner::scalarMask(const char *json, int length)
+{
+    quint64 mask = 0;
+    for (int i = 0; i < length; ++i) {
+        if (isStructural(json[i]))
+            mask |= Q_UINT64_C(1) << i;
+    }
+    return mask;
+}
+
+// setting 0x20 folds [ into { and ] into }, and no other character into either
+#ifdef __SSE2__
+static quint64 sse2Mask64(const char *json)
+{
+    quint64 mask = 0;
+    for (int i = 0; i < 64; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(json + i));
+        const __m128i folded = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                       _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(':')));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')));
+        mask |= quint64(quint16(_mm_movemask_epi8(matches))) << i;
+    }
+    return mask;
+}
+#endif
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+QT_FUNCTION_TARGET(AVX2)
+static quint64 avx2Mask64(const char *json)
+{
+    quint64 mask = 0;
+    for (int i = 0; i < 64; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(json + i));
+        const __m256i folded = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                                          _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')));
+        matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')));
+        mask |= quint64(quint32(_mm256_movemask_epi8(matches))) << i;
+    }
+    return mask;
+}
+#endif
+
+typedef quint64 (*CouchJsonMask64)(const char *json);
+
+static CouchJsonMask64 resolveMask64()
+{
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2))
+        return avx2Mask64;
+#endif
+#ifdef __SSE2__
+    return sse2Mask64;
+#else
+    return [](const char *json) { return CouchJsonScanner::scalarMask(json, 64); };
+#endif
+}
+
+quint64 CouchJsonScanner::mask(const char *json, int length)
+{
+    static const CouchJsonMask64 mask64 = resolveMask64();
+    if (length >= 64)
+        return mask64(json);
+    return scalarMask(json, length);
+}
+
+int CouchJson::skipValue(const char *json, int pos, int end)
+{
+    if (pos >= end)
+        return end;
+
+    const char c = json[pos];
+    if (c == '"' || c == '{' || c == '[') {
+        CouchJsonScanner scanner(json, pos, end);
+        bool inString = false;
+        int depth = 0;
+        for (int p = scanner.next(); p != -1; p = scanner.next()) {
+            const char s = json[p];
+            if (inString) {
+                if (s == '\\') {
+                    scanner.skip(p + 1);
+                } else if (s == '"') {
+                    inString = false;
+                    if (depth == 0)
+                        return p + 1;
+                }
+                continue;
+            }
+
+            if (s == '"') {
+                inString = true;
+            } else if (s == '{' || s == '[') {
+                ++depth;
+            } else if (s == '}' || s == ']') {
+                if (--depth == 0)
+                    return p + 1;
+            }
+        }
+        return end;
+    }
+
+    // numbers, true, false and null
+    while (pos < end && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' && !isWhitespace(json[pos]))
+        ++pos;
+    return pos;
+}
+
+void CouchJson::forEachMember(const char *json, const CouchJsonSpan &object,
+                              const std::function<void(const QByteArray &, const CouchJsonSpan &)> &callback)
+{
+    const int end = object.start + object.length;
+    int pos = skipWhitespace(json, object.start, end);
+    if (pos >= end || json[pos] != '{')
+        return;
+
+    ++pos;
+    while (true) {
+        pos = skipWhitespace(json, pos, end);
+        if (pos >= end || json[pos] != '"')
+            return;
+
+        const int keyEnd = skipValue(json, pos, end);
+        const QByteArray key = QByteArray::fromRawData(json + pos + 1, qMax(0, keyEnd - pos - 2));
+        pos = skipWhitespace(json, keyEnd, end);
+        if (pos >= end || json[pos] != ':')
+            return;
+
+        const int valueStart = skipWhitespace(json, pos + 1, end);
+        const int valueEnd = skipValue(json, valueStart, end);
+        if (valueStart >= end)
+            return;
+        callback(key, CouchJsonSpan(valueStart, valueEnd - valueStart));
+
+        pos = skipWhitespace(json, valueEnd, end);
+        if (pos >= end || json[pos] != ',')
+            return;
+        ++pos;
+    }
+}
+
+void CouchJson::forEachElement(const char *json, const CouchJsonSpan &array,
+                               const std::function<void(const CouchJsonSpan &)> &callback)
+{
+    const int end = array.start + array.length;
+    int pos = skipWhitespace(json, array.start, end);
+    if (pos >= end || json[pos] != '[')
+        return;
+
+    ++pos;
+    while (true) {
+        pos = skipWhitespace(json, pos, end);
+        if (pos >= end || json[pos] == ']')
+            return;
+
+        const int valueEnd = skipValue(json, pos, end);
+        callback(CouchJsonSpan(pos, valueEnd - pos));
+
+        pos = skipWhitespace(json, valueEnd, end);
+        if (pos >= end || json[pos] != ',')
+            return;
+        ++pos;
+    }
+}
+
+CouchJsonMembers CouchJson::members(const char *json, const CouchJsonSpan &object)
+{
+    CouchJsonMembers members;
+    forEachMember(json, object, [&](const QByteArray &key, const CouchJsonSpan &value) {
+        if (json[value.start] == '"') {
+            if (key == "_id")
+                members._id = value;
+            else if (key == "id")
+                members.id = value;
+            else if (key == "_rev")
+                members._rev = value;
+            else if (key == "rev")
+                members.rev = value;
+        }
+        if (key == "key")
+            members.key = value;
+        else if (key == "value")
+            members.value = value;
+        else if (key == "doc")
+            members.doc = value;
+    });
+    return members;
+}
+
+static CouchJsonSpan findValue(const char *json, const CouchJsonMembers &members, bool revision)
+{
+    const CouchJsonSpan &underscored = revision ? members._rev : members._id;
+    if (underscored.isValid())
+        return underscored;
+    const CouchJsonSpan &plain = revision ? members.rev : members.id;
+    if (plain.isValid())
+        return plain;
+
+    // members() finds nothing in children that are not objects
+    for (const CouchJsonSpan &child : {members.doc, members.value}) {
+        if (!child.isValid())
+            continue;
+        const CouchJsonMembers childMembers = CouchJson::members(json, child);
+        const CouchJsonSpan &value = revision ? childMembers.rev : childMembers.id;
+        if (value.isValid())
+            return value;
+    }
+    return CouchJsonSpan();
+}
+
+CouchJsonSpan CouchJson::findId(const char *json, const CouchJsonMembers &members)
+{
+    return findValue(json, members, false);
+}
+
+CouchJsonSpan CouchJson::findRevision(const char *json, const CouchJsonMembers &members)
+{
+    return findValue(json, members, true);
+}
+
+QString CouchJson::toString(const QByteArray &source, const CouchJsonSpan &span)
+{
+    if (!span.isValid() || span.length < 2)
+        return QString();
+
+    const char *str = source.constData() + span.start + 1;
+    const int length = span.length - 2;
+    if (!memchr(str, '\\', length))
+        return QString::fromUtf8(str, length);
+
+    // let QJsonDocument deal with escape sequences
+    QByteArray array = '[' + QByteArray::fromRawData(source.constData() + span.start, span.length) + ']';
+    return QJsonDocument::fromJson(array).array().at(0).toString();
+}
+
+void CouchJson::appendString(QByteArray &json, const QString &str)
+{
+    const QByteArray utf8 = str.toUtf8();
+    json += '"';
+    for (char c : utf8) {
+        switch (c) {
+        case '"':
+            json += "\\\"";
+            break;
+        case '\\':
+            json += "\\\\";
+            break;
+        case '\n':
+            json += "\\n";
+            break;
+        case '\r':
+            json += "\\r";
+            break;
+        case '\t':
+            json += "\\t";
+            break;
+        default:
+            if (uchar(c) < 0x20)
+                json += "\\u00" + QByteArray::number(uchar(c), 16).rightJustified(2, '0');
+            else
+                json += c;
+            break;
+        }
+    }
+    json += '"';
+}
@@ -0,0 +1,104 @@
+#ifndef COUCHJSON_P_H
+#define COUCHJSON_P_H
+
+#include <QtCouchDB/couchglobal.h>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+
+#include <functional>
+
+struct CouchJsonSpan
+{
+    CouchJsonSpan() = default;
+    CouchJsonSpan(int start, int length) : start(start), length(length) { }
+
+    int start = -1;
+    int length = 0;
+
+    bool isValid() const { return start >= 0; }
+};
+
+// walks the structural characters of JSON text: quotes, backslashes,
+// brackets, braces, colons and commas. The characters are located 64 bytes
+// at a time with SIMD instructions where available.
+class COUCHDB_EXPORT CouchJsonScanner
+{
+public:
+    CouchJsonScanner(const char *json, int pos, int end)
+        : m_json(json), m_block(pos), m_end(end), m_mask(pos < end ? mask(json + pos, qMin(64, end - pos)) : 0) { }
+
+    // the position of the next structural character, or -1 at the end
+    int next()
+    {
+        while (!m_mask) {
+            m_block += 64;
+            if (m_block >= m_end)
+                return -1;
+            m_mask = mask(m_json + m_block, qMin(64, m_end - m_block));
+            if (m_skip >= m_block && m_skip < m_block + 64)
+                m_mask &= ~(Q_UINT64_C(1) << (m_skip - m_block));
+        }
+        const int pos = m_block + qCountTrailingZeroBits(m_mask);
+        m_mask &= m_mask - 1;
+        return pos;
+    }
+
+    // ignores the character at pos, e.g. the one after a backslash in a string
+    void skip(int pos)
+    {
+        m_skip = pos;
+        if (pos >= m_block && pos < m_block + 64)
+            m_mask &= ~(Q_UINT64_C(1) << (pos - m_block));
+    }
+
+    // a bit for each structural character in the first length (at most 64) bytes
+    static quint64 mask(const char *json, int length);
+    static quint64 scalarMask(const char *json, int length);
+
+private:
+    const char *m_json;
+    int m_block;
+    int m_end;
+    int m_skip = -1;
+    quint64 m_mask;
+};
+
+// the spans of the members a row or a document is looked up by
+struct CouchJsonMembers
+{
+    CouchJsonSpan id;
+    CouchJsonSpan _id;
+    CouchJsonSpan rev;
+    CouchJsonSpan _rev;
+    CouchJsonSpan key;
+    CouchJsonSpan value;
+    CouchJsonSpan doc;
+};
+
+// a scanner that locates values in JSON text without decoding anything:
+// spans of strings include their quotes, objects and arrays their brackets
+class COUCHDB_EXPORT CouchJson
+{
+public:
+    static int skipValue(const char *json, int pos, int end);
+
+    static void forEachMember(const char *json, const CouchJsonSpan &object,
+                              const std::function<void(const QByteArray &key, const CouchJsonSpan &value)> &callback);
+    static void forEachElement(const char *json, const CouchJsonSpan &array,
+                               const std::function<void(const CouchJsonSpan &value)> &callback);
+
+    static CouchJsonMembers members(const char *json, const CouchJsonSpan &object);
+
+    // the same lookup order as CouchDocument::fromJson():
+    // _key or key, then doc.key, then value.key
+    static CouchJsonSpan findId(const char *json, const CouchJsonMembers &members);
+    static CouchJsonSpan findRevision(const char *json, const CouchJsonMembers &members);
+
+    static QString toString(const QByteArray &source, const CouchJsonSpan &span);
+
+    // appends str as a quoted and escaped JSON string
+    static void appendString(QByteArray &json, const QString &str);
+};
+
+#endif // COUCHJSON_P_H
@@ -0,0 +1,261 @@
+#include "couchmetrics.h"
+#include "couchmetrics_p.h"
+#include "couchurl_p.h"
+
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qurl.h>
+
+#include <functional>
+
+// 32 buckets per power of two, the error of a reported value is below 3%
+static const int SubBucketBits = 5;
+static const int SubBucketCount = 1 << SubBucketBits;
+static const int SubBucketHalf = SubBucketCount / 2;
+
+static const qreal Quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+int CouchHistogram::bucketIndex(qint64 value)
+{
+    if (value < SubBucketCount)
+        return int(qMax<qint64>(0, value));
+
+    // the highest bits of the value select a sub-bucket within its power of two
+    int shift = 64 - qCountLeadingZeroBits(quint64(value)) - SubBucketBits;
+    return SubBucketCount + (shift - 1) * SubBucketHalf + int(value >> shift) - SubBucketHalf;
+}
+
+qint64 CouchHistogram::bucketValue(int index)
+{
+    if (index < SubBucketCount)
+        return index;
+
+    int shift = (index - SubBucketCount) / SubBucketHalf + 1;
+    qint64 subBucket = (index - SubBucketCount) % SubBucketHalf + SubBucketHalf;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void CouchHistogram::record(qint64 value)
+{
+    value = qMax<qint64>(0, value);
+    int index = bucketIndex(value);
+    if (index >= m_buckets.count())
+        m_buckets.resize(index + 1);
+
+    ++m_buckets[index];
+    ++m_count;
+    m_sum += value;
+    m_max = qMax(m_max, value);
+}
+
+qint64 CouchHistogram::value(qreal quantile) const
+{
+    if (m_count == 0)
+        return 0;
+
+    qint64 rank = qBound<qint64>(1, qCeil(qBound<qreal>(0, quantile, 1) * m_count), m_count);
+    qint64 seen = 0;
+    for (int i = 0; i < m_buckets.count(); ++i) {
+        seen += m_buckets.at(i);
+        if (seen >= rank)
+            return qMin(bucketValue(i), m_max);
+    }
+    return m_max;
+}
+
+CouchMetricsSeries &CouchMetricsPrivate::series(CouchRequest::Operation operation, CouchMetrics::Endpoint endpoint)
+{
+    return table[qBound<int>(0, operation, OperationCount - 1)][qBound<int>(0, endpoint, EndpointCount - 1)];
+}
+
+const CouchMetricsSeries &CouchMetricsPrivate::series(CouchRequest::Operation operation, CouchMetrics::Endpoint endpoint) const
+{
+    return table[qBound<int>(0, operation, OperationCount - 1)][qBound<int>(0, endpoint, EndpointCount - 1)];
+}
+
+CouchMetrics::CouchMetrics()
+    : d_ptr(new CouchMetricsPrivate)
+{
+}
+
+CouchMetrics::~CouchMetrics()
+{
+}
+
+CouchMetrics::CouchMetrics(const CouchMetrics &other)
+    : d_ptr(other.d_ptr)
+{
+}
+
+CouchMetrics &CouchMetrics::operator=(const CouchMetrics &other)
+{
+    d_ptr = other.d_ptr;
+    return *this;
+}
+
+template <typename T, typename Getter>
+static T total(const CouchMetricsPrivate *d, Getter get)
+{
+    T sum = 0;
+    for (const auto &operation : d->table) {
+        for (const CouchMetricsSeries &series : operation)
+            sum += get(series);
+    }
+    return sum;
+}
+
+int CouchMetrics::requestCount() const
+{
+    Q_D(const CouchMetrics);
+    return total<int>(d, [](const CouchMetricsSeries &series) { return series.requests; });
+}
+
+int CouchMetrics::requestCount(CouchRequest::Operation operation, Endpoint endpoint) const
+{
+    Q_D(const CouchMetrics);
+    return d->series(operation, endpoint).requests;
+}
+
+int CouchMetrics::errorCount() const
+{
+    Q_D(const CouchMetrics);
+    return total<int>(d, [](const CouchMetricsSeries &series) { return series.errors; });
+}
+
+int CouchMetrics::errorCount(CouchRequest::Operation operation, Endpoint endpoint) const
+{
+    Q_D(const CouchMetrics);
+    return d->series(operation, endpoint).errors;
+}
+
+qint64 CouchMetrics::bytesSent() const
+{
+    Q_D(const CouchMetrics);
+    return total<qint64>(d, [](const CouchMetricsSeries &series) { return series.bytesSent; });
+}
+
+qint64 CouchMetrics::bytesSent(CouchRequest::Operation operation, Endpoint endpoint) const
+{
+    Q_D(const CouchMetrics);
+    return d->series(operation, endpoint).bytesSent;
+}
+
+qint64 CouchMetrics::bytesReceived() const
+{
+    Q_D(const CouchMetrics);
+    return total<qint64>(d, [](const CouchMetricsSeries &series) { return series.bytesReceived; });
+}
+
+qint64 CouchMetrics::bytesReceived(CouchRequest::Operation operation, Endpoint endpoint) const
+{
+    Q_D(const CouchMetrics);
+    return d->series(operation, endpoint).bytesReceived;
+}
+
+qint64 CouchMetrics::latency(CouchRequest::Operation operation, Endpoint endpoint, qreal quantile) const
+{
+    Q_D(const CouchMetrics);
+    return d->series(operation, endpoint).latency.value(quantile);
+}
+
+static QByteArray labels(int operation, int endpoint)
+{
+    static const char *const endpoints[] = { "server", "database", "document", "all_docs", "bulk_docs", "view" };
+    QByteArray key = QMetaEnum::fromType<CouchRequest::Operation>().valueToKey(operation);
+    return "operation=\"" + key.toLower() + "\",endpoint=\"" + endpoints[endpoint] + '"';
+}
+
+static QByteArray seconds(qint64 microseconds)
+{
+    return QByteArray::number(microseconds / 1e6, 'f', 6);
+}
+
+QByteArray CouchMetrics::toPrometheus() const
+{
+    Q_D(const CouchMetrics);
+    struct Counter {
+        const char *name;
+        const char *help;
+        std::function<qint64(const CouchMetricsSeries &)> value;
+    };
+    const Counter counters[] = {
+        { "couchdb_client_requests_total", "Requests finished by the client.",
+          [](const CouchMetricsSeries &series) -> qint64 { return series.requests; } },
+        { "couchdb_client_errors_total", "Requests finished with an error.",
+          [](const CouchMetricsSeries &series) -> qint64 { return series.errors; } },
+        { "couchdb_client_sent_bytes_total", "Request body bytes sent.",
+          [](const CouchMetricsSeries &series) -> qint64 { return series.bytesSent; } },
+        { "couchdb_client_received_bytes_total", "Response body bytes received.",
+          [](const CouchMetricsSeries &series) -> qint64 { return series.bytesReceived; } },
+    };
+
+    // series that never saw a request are left out
+    QByteArray text;
+    for (const Counter &counter : counters) {
+        text += QByteArray("# HELP ") + counter.name + ' ' + counter.help + '\n';
+        text += QByteArray("# TYPE ") + counter.name + " counter\n";
+        for (int o = 0; o < OperationCount; ++o) {
+            for (int e = 0; e < EndpointCount; ++e) {
+                const CouchMetricsSeries &series = d->table[o][e];
+                if (series.requests > 0 || series.bytesSent > 0)
+                    text += counter.name + ('{' + labels(o, e) + "} ") + QByteArray::number(counter.value(series)) + '\n';
+            }
+        }
+    }
+
+    const QByteArray duration = "couchdb_client_request_duration_seconds";
+    text += "# HELP " + duration + " Request latency from sending to finishing.\n";
+    text += "# TYPE " + duration + " summary\n";
+    for (int o = 0; o < OperationCount; ++o) {
+        for (int e = 0; e < EndpointCount; ++e) {
+            const CouchHistogram &latency = d->table[o][e].latency;
+            if (latency.count() == 0)
+                continue;
+
+            const QByteArray label = labels(o, e);
+            for (qreal quantile : Quantiles)
+                text += duration + '{' + label + ",quantile=\"" + QByteArray::number(quantile) + "\"} " + seconds(latency.value(quantile)) + '\n';
+            text += duration + "_sum{" + label + "} " + seconds(latency.sum()) + '\n';
+            text += duration + "_count{" + label + "} " + QByteArray::number(latency.count()) + '\n';
+        }
+    }
+    return text;
+}
+
+CouchMetrics::Endpoint CouchMetrics::endpoint(const QUrl &url, const QUrl &baseUrl)
+{
+    QStringList segments = url.path().split(Slash, Qt::SkipEmptyParts);
+    if (segments.contains(QStringLiteral("_view")))
+        return ViewEndpoint;
+
+    const QString last = segments.isEmpty() ? QString() : segments.last();
+    if (last == QLatin1String("_all_docs") || last == QLatin1String("_design_docs"))
+        return AllDocsEndpoint;
+    if (last == QLatin1String("_bulk_docs") || last == QLatin1String("_bulk_get"))
+        return BulkDocsEndpoint;
+
+    // the rest is told apart by its depth below the server
+    int depth = segments.count() - baseUrl.path().split(Slash, Qt::SkipEmptyParts).count();
+    if (depth <= 0 || segments.at(segments.count() - depth).startsWith(QLatin1Char('_')))
+        return ServerEndpoint;
+    if (depth == 1)
+        return DatabaseEndpoint;
+
+    // _find, _changes and the like work on the database as a whole
+    const QString resource = segments.at(segments.count() - depth + 1);
+    if (resource.startsWith(QLatin1Char('_')) && resource != QLatin1String("_design") && resource != QLatin1String("_local"))
+        return DatabaseEndpoint;
+    return DocumentEndpoint;
+}
+
+QDebug operator<<(QDebug debug, const CouchMetrics &metrics)
+{
+    QDebugStateSaver saver(debug);
+    debug.nospace().noquote() << "CouchMetrics(requests=" << metrics.requestCount()
+                              << ", errors=" << metrics.errorCount()
+                              << ", sent=" << metrics.bytesSent()
+                              << ", received=" << metrics.bytesReceived() << ')';
+    return debug;
+}
@@ -0,0 +1,67 @@
+#ifndef COUCHMETRICS_H
+#define COUCHMETRICS_H
+
+#include <QtCouchDB/couchglobal.h>
+#include <QtCouchDB/couchrequest.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qobjectdefs.h>
+#include <QtCore/qshareddata.h>
+
+class CouchMetricsPrivate;
+
+class COUCHDB_EXPORT CouchMetrics
+{
+    Q_GADGET
+    Q_PROPERTY(int requestCount READ requestCount)
+    Q_PROPERTY(int errorCount READ errorCount)
+    Q_PROPERTY(qint64 bytesSent READ bytesSent)
+    Q_PROPERTY(qint64 bytesReceived READ bytesReceived)
+
+public:
+    enum Endpoint
+    {
+        ServerEndpoint,
+        DatabaseEndpoint,
+        DocumentEndpoint,
+        AllDocsEndpoint,
+        BulkDocsEndpoint,
+        ViewEndpoint
+    };
+    Q_ENUM(Endpoint)
+
+    CouchMetrics();
+    ~CouchMetrics();
+
+    CouchMetrics(const CouchMetrics &other);
+    CouchMetrics &operator=(const CouchMetrics &other);
+
+    int requestCount() const;
+    int requestCount(CouchRequest::Operation operation, Endpoint endpoint) const;
+
+    int errorCount() const;
+    int errorCount(CouchRequest::Operation operation, Endpoint endpoint) const;
+
+    qint64 bytesSent() const;
+    qint64 bytesSent(CouchRequest::Operation operation, Endpoint endpoint) const;
+
+    qint64 bytesReceived() const;
+    qint64 bytesReceived(CouchRequest::Operation operation, Endpoint endpoint) const;
+
+    // in microseconds, e.g. latency(Get, DocumentEndpoint, 0.99) for p99
+    qint64 latency(CouchRequest::Operation operation, Endpoint endpoint, qreal quantile) const;
+
+    QByteArray toPrometheus() const;
+
+    static Endpoint endpoint(const QUrl &url, const QUrl &baseUrl = QUrl());
+
+private:
+    Q_DECLARE_PRIVATE(CouchMetrics)
+    QExplicitlySharedDataPointer<CouchMetricsPrivate> d_ptr;
+};
+
+COUCHDB_EXPORT QDebug operator<<(QDebug debug, const CouchMetrics &metrics);
+
+Q_DECLARE_METATYPE(CouchMetrics)
+
+#endif // COUCHMETRICS_H
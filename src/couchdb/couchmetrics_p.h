@@ -0,0 +1,59 @@
+#ifndef COUCHMETRICS_P_H
+#define COUCHMETRICS_P_H
+
+#include <QtCouchDB/couchmetrics.h>
+#include <QtCouchDB/couchrequest.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qvector.h>
+
+static const int OperationCount = CouchRequest::Delete + 1;
+static const int EndpointCount = CouchMetrics::ViewEndpoint + 1;
+
+// a log-linear histogram in the spirit of HdrHistogram: values are bucketed
+// with a fixed relative precision, so recording is cheap at any magnitude
+class CouchHistogram
+{
+public:
+    void record(qint64 value);
+
+    qint64 count() const { return m_count; }
+    qint64 sum() const { return m_sum; }
+    qint64 max() const { return m_max; }
+    qint64 value(qreal quantile) const;
+
+    static int bucketIndex(qint64 value);
+    static qint64 bucketValue(int index);
+
+private:
+    QVector<qint64> m_buckets;
+    qint64 m_count = 0;
+    qint64 m_sum = 0;
+    qint64 m_max = 0;
+};
+
+struct CouchMetricsSeries
+{
+    int requests = 0;
+    int errors = 0;
+    qint64 bytesSent = 0;
+    qint64 bytesReceived = 0;
+    CouchHistogram latency;
+};
+
+class CouchMetricsPrivate : public QSharedData
+{
+public:
+    // recording into a snapshot that has been handed out detaches it first
+    static CouchMetricsPrivate *get(CouchMetrics &metrics)
+    {
+        metrics.d_ptr.detach();
+        return metrics.d_ptr.data();
+    }
+
+    CouchMetricsSeries &series(CouchRequest::Operation operation, CouchMetrics::Endpoint endpoint);
+    const CouchMetricsSeries &series(CouchRequest::Operation operation, CouchMetrics::Endpoint endpoint) const;
+
+    CouchMetricsSeries table[OperationCount][EndpointCount];
+};
+
+#endif // COUCHMETRICS_P_H
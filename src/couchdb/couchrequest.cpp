@@ -1,4 +1,5 @@
 #include "couchrequest.h"
+#include "couchurl_p.h"
 
 #include <QtCore/qmetaobject.h>
 
@@ -8,6 +9,9 @@ public:
     QUrl url;
     CouchRequest::Operation operation = CouchRequest::Get;
     QByteArray body;
+    CouchRequest::Priority priority = CouchRequest::Normal;
+    int timeout = -1;
+    int connectTimeout = -1;
     QHash<QByteArray, QByteArray> headers;
 };
 
@@ -37,7 +41,8 @@ CouchRequest &CouchRequest::operator=(const CouchRequest &other)
 bool CouchRequest::operator==(const CouchRequest &other) const
 {
     Q_D(const CouchRequest);
-    return d_ptr == other.d_ptr || (d->operation == other.operation() &&
+    return d_ptr == other.d_ptr || (d->url == other.url() &&
+                                    d->operation == other.operation() &&
                                     d->body == other.body() &&
                                     d->headers == other.headers());
 }
@@ -92,6 +97,48 @@ void CouchRequest::setBody(const QByteArray &body)
     d->body = body;
 }
 
+CouchRequest::Priority CouchRequest::priority() const
+{
+    Q_D(const CouchRequest);
+    return d->priority;
+}
+
+void CouchRequest::setPriority(Priority priority)
+{
+    d_ptr.detach();
+    d_ptr->priority = priority;
+}
+
+int CouchRequest::timeout() const
+{
+    Q_D(const CouchRequest);
+    return d->timeout;
+}
+
+void CouchRequest::setTimeout(int timeout)
+{
+    if (d_ptr->timeout == timeout)
+        return;
+
+    d_ptr.detach();
+    d_ptr->timeout = timeout;
+}
+
+int CouchRequest::connectTimeout() const
+{
+    Q_D(const CouchRequest);
+    return d->connectTimeout;
+}
+
+void CouchRequest::setConnectTimeout(int connectTimeout)
+{
+    if (d_ptr->connectTimeout == connectTimeout)
+        return;
+
+    d_ptr.detach();
+    d_ptr->connectTimeout = connectTimeout;
+}
+
 QHash<QByteArray, QByteArray> CouchRequest::headers() const
 {
     Q_D(const CouchRequest);
@@ -111,13 +158,6 @@ void CouchRequest::setHeader(const QByteArray &header, const QByteArray &value)
     d->headers.insert(header, value);
 }
 
-static QString maskedUrl(QUrl url)
-{
-    if (!url.password().isEmpty())
-        url.setPassword(QStringLiteral("xxxxx"));
-    return url.toString();
-}
-
 static const char *toKey(CouchRequest::Operation operation)
 {
     return QMetaEnum::fromType<CouchRequest::Operation>().key(operation);
@@ -126,7 +166,7 @@ static const char *toKey(CouchRequest::Operation operation)
 QDebug operator<<(QDebug debug, const CouchRequest &request)
 {
     QDebugStateSaver saver(debug);
-    debug.nospace() << "CouchRequest(" << toKey(request.operation()) << ", " << qPrintable(maskedUrl(request.url()));
+    debug.nospace() << "CouchRequest(" << toKey(request.operation()) << ", " << qPrintable(CouchUrl::masked(request.url()));
     if (request.operation() == CouchRequest::Post)
         debug.nospace() << ", " << request.body();
     debug.nospace() << ')';
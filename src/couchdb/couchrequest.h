@@ -19,6 +19,9 @@ class COUCHDB_EXPORT CouchRequest
     Q_PROPERTY(QUrl url READ url)
     Q_PROPERTY(Operation operation READ operation)
     Q_PROPERTY(QByteArray body READ body)
+    Q_PROPERTY(Priority priority READ priority)
+    Q_PROPERTY(int timeout READ timeout)
+    Q_PROPERTY(int connectTimeout READ connectTimeout)
 
 public:
     enum Operation
@@ -30,6 +33,14 @@ public:
     };
     Q_ENUM(Operation)
 
+    enum Priority
+    {
+        Interactive,
+        Normal,
+        Bulk
+    };
+    Q_ENUM(Priority)
+
     CouchRequest(Operation operation = Get);
     ~CouchRequest();
 
@@ -50,6 +61,15 @@ public:
     QByteArray body() const;
     void setBody(const QByteArray &body);
 
+    Priority priority() const;
+    void setPriority(Priority priority);
+
+    int timeout() const;
+    void setTimeout(int timeout);
+
+    int connectTimeout() const;
+    void setConnectTimeout(int connectTimeout);
+
     QHash<QByteArray, QByteArray> headers() const;
     QByteArray header(const QByteArray &header) const;
     void setHeader(const QByteArray &header, const QByteArray &value);
@@ -63,5 +83,6 @@ COUCHDB_EXPORT QDebug operator<<(QDebug debug, const CouchRequest &request);
 
 Q_DECLARE_METATYPE(CouchRequest)
 Q_DECLARE_METATYPE(CouchRequest::Operation)
+Q_DECLARE_METATYPE(CouchRequest::Priority)
 
 #endif // COUCHREQUEST_H
@@ -1,14 +1,12 @@
 #include "couchresponse.h"
+#include "couchresponse_p.h"
+#include "couchclient_p.h"
 
 #include <QtCore/qjsonobject.h>
 #include <QtCore/qjsondocument.h>
+#include <QtCore/qstringlist.h>
 
-class CouchResponsePrivate
-{
-public:
-    CouchRequest request;
-    QByteArray data;
-};
+#include <algorithm>
 
 CouchResponse::CouchResponse(const CouchRequest &request, QObject *parent) :
     QObject(parent),
@@ -20,6 +18,69 @@ CouchResponse::CouchResponse(const CouchRequest &request, QObject *parent) :
 
 CouchResponse::~CouchResponse()
 {
+    Q_D(CouchResponse);
+    if (d->client && !d->finished)
+        d->client->dropRequest(this);
+}
+
+void CouchResponsePrivate::completeDelivery(CouchResponse *response)
+{
+    CouchResponsePrivate *r = get(response);
+    if (!r->decoding)
+        return;
+
+    r->decoding = false;
+    if (!r->reached(CouchResponse::Parsed))
+        r->mark(CouchResponse::Parsed);
+    if (r->client)
+        r->client->completeResponse(response, CouchError(), false);
+}
+
+void CouchResponsePrivate::reset()
+{
+    // pending timers and callbacks compare generations to ignore a recycled response
+    ++generation;
+    request = CouchRequest();
+    reply.clear();
+    leader.clear();
+    abortError = CouchError();
+    error = CouchError();
+    aborted = false;
+    finished = false;
+    failed = false;
+    delivered = false;
+    elapsed.invalidate();
+    clearTimestamps();
+    endpoint = CouchMetrics::ServerEndpoint;
+    data.clear();
+    batchSize = 0;
+    attempts = 0;
+    status = 0;
+    bytesSent = 0;
+    bytesReceived = 0;
+    rowsDelivered = false;
+    decoding = false;
+    reauthenticated = false;
+    acceptEncoding = false;
+    encodingChecked = false;
+    cachedEtag.clear();
+    cachedData.clear();
+    rowParser.reset();
+    inflater.reset();
+    followers.clear();
+    onReceived = nullptr;
+    onError = nullptr;
+}
+
+void CouchResponsePrivate::clearTimestamps()
+{
+    std::fill(timestamps, timestamps + PhaseCount, -1);
+}
+
+void CouchResponsePrivate::mark(CouchResponse::Phase phase)
+{
+    if (elapsed.isValid())
+        timestamps[phase] = elapsed.nsecsElapsed() / 1000;
 }
 
 CouchRequest CouchResponse::request() const
@@ -45,6 +106,59 @@ void CouchResponse::setData(const QByteArray &data)
     d->data = data;
 }
 
+int CouchResponse::batchSize() const
+{
+    Q_D(const CouchResponse);
+    return d->batchSize;
+}
+
+void CouchResponse::setBatchSize(int batchSize)
+{
+    Q_D(CouchResponse);
+    d->batchSize = qMax(0, batchSize);
+}
+
+int CouchResponse::attempts() const
+{
+    Q_D(const CouchResponse);
+    return d->attempts;
+}
+
+qint64 CouchResponse::timestamp(Phase phase) const
+{
+    Q_D(const CouchResponse);
+    if (phase < Enqueued || phase > Delivered)
+        return -1;
+
+    return d->timestamps[phase];
+}
+
+QString CouchResponse::timingSummary() const
+{
+    Q_D(const CouchResponse);
+    static const char *const spans[] = { "queued", "waiting", "download", "parse", "delivery" };
+
+    // each span ends at a phase, phases that were skipped add to the next span
+    QStringList parts;
+    qint64 previous = qMax<qint64>(0, d->timestamps[Enqueued]);
+    for (int phase = Dispatched; phase <= Delivered; ++phase) {
+        qint64 timestamp = d->timestamps[phase];
+        if (timestamp < 0)
+            continue;
+        parts += QStringLiteral("%1 %2 ms").arg(QLatin1String(spans[phase - 1])).arg((timestamp - previous) / 1000.0, 0, 'f', 1);
+        previous = timestamp;
+    }
+    parts += QStringLiteral("total %1 ms").arg(previous / 1000.0, 0, 'f', 1);
+    return parts.join(QStringLiteral(", "));
+}
+
+void CouchResponse::abort()
+{
+    Q_D(CouchResponse);
+    if (d->client)
+        d->client->abortRequest(this, CouchError(0, QStringLiteral("OperationCanceledError"), QStringLiteral("Operation canceled")));
+}
+
 QJsonObject CouchResponse::toJson() const
 {
     Q_D(const CouchResponse);
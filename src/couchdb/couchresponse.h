@@ -3,6 +3,7 @@
 
 #include <QtCouchDB/couchglobal.h>
 #include <QtCouchDB/coucherror.h>
+#include <QtCouchDB/couchdocument.h>
 #include <QtCouchDB/couchrequest.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
@@ -15,8 +16,21 @@ class COUCHDB_EXPORT CouchResponse : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QByteArray data READ data)
+    Q_PROPERTY(int batchSize READ batchSize WRITE setBatchSize)
+    Q_PROPERTY(int attempts READ attempts)
 
 public:
+    enum Phase
+    {
+        Enqueued,
+        Dispatched,
+        FirstByte,
+        Finished,
+        Parsed,
+        Delivered
+    };
+    Q_ENUM(Phase)
+
     CouchResponse(const CouchRequest &request = CouchRequest(), QObject *parent = nullptr);
     ~CouchResponse();
 
@@ -26,10 +40,22 @@ public:
     QByteArray data() const;
     void setData(const QByteArray &data);
 
+    int batchSize() const;
+    void setBatchSize(int batchSize);
+
+    int attempts() const;
+
+    qint64 timestamp(Phase phase) const;
+    QString timingSummary() const;
+
     QJsonObject toJson() const;
 
+public slots:
+    void abort();
+
 signals:
     void received(const QByteArray &data);
+    void rowsReceived(const QList<CouchDocument> &rows);
     void errorOccurred(const CouchError &error);
 
 private:
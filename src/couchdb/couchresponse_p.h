@@ -0,0 +1,75 @@
+#ifndef COUCHRESPONSE_P_H
+#define COUCHRESPONSE_P_H
+
+#include <QtCouchDB/couchresponse.h>
+#include <QtCouchDB/coucherror.h>
+#include <QtCouchDB/couchrequest.h>
+#include <QtCouchDB/couchmetrics.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qscopedpointer.h>
+
+#include <functional>
+
+#include "couchcompression_p.h"
+#include "couchrowparser_p.h"
+
+class CouchClientPrivate;
+QT_FORWARD_DECLARE_CLASS(QNetworkReply)
+
+static const int PhaseCount = CouchResponse::Delivered + 1;
+
+class CouchResponsePrivate
+{
+public:
+    CouchResponsePrivate() { clearTimestamps(); }
+
+    static CouchResponsePrivate *get(CouchResponse *response) { return response->d_func(); }
+
+    void reset();
+    void clearTimestamps();
+    void mark(CouchResponse::Phase phase);
+    bool reached(CouchResponse::Phase phase) const { return timestamps[phase] >= 0; }
+
+    // for handlers that go on decoding after received has returned, the
+    // response is delivered once they call completeDelivery()
+    void deferDelivery() { decoding = true; }
+    static void completeDelivery(CouchResponse *response);
+
+    CouchRequest request;
+    CouchClientPrivate *client = nullptr;
+    QPointer<QNetworkReply> reply;
+    QPointer<CouchResponse> leader;
+    CouchError abortError;
+    CouchError error;
+    bool aborted = false;
+    bool finished = false;
+    bool failed = false;
+    bool delivered = false;
+    int generation = 0;
+    QElapsedTimer elapsed;
+    qint64 timestamps[PhaseCount];
+    CouchMetrics::Endpoint endpoint = CouchMetrics::ServerEndpoint;
+    QByteArray data;
+    int batchSize = 0;
+    int attempts = 0;
+    int status = 0;
+    qint64 bytesSent = 0;
+    qint64 bytesReceived = 0;
+    bool rowsDelivered = false;
+    bool decoding = false;
+    bool reauthenticated = false;
+    bool acceptEncoding = false;
+    bool encodingChecked = false;
+    QByteArray cachedEtag;
+    QByteArray cachedData;
+    QScopedPointer<CouchRowParser> rowParser;
+    QScopedPointer<CouchInflater> inflater;
+    QList<QPointer<CouchResponse>> followers;
+    std::function<void(const QByteArray &)> onReceived;
+    std::function<void(const CouchError &)> onError;
+};
+
+#endif // COUCHRESPONSE_P_H
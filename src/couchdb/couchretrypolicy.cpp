@@ -0,0 +1,159 @@
+#include "couchretrypolicy.h"
+
+#include <QtCore/qrandom.h>
+
+class CouchRetryPolicyPrivate : public QSharedData
+{
+public:
+    int maxAttempts = 1;
+    int baseDelay = 100;
+    int maxDelay = 10000;
+    QList<int> statusCodes = {500, 502, 503, 504};
+    bool retryNetworkErrors = true;
+};
+
+CouchRetryPolicy::CouchRetryPolicy()
+    : d_ptr(new CouchRetryPolicyPrivate)
+{
+}
+
+CouchRetryPolicy::~CouchRetryPolicy()
+{
+}
+
+CouchRetryPolicy::CouchRetryPolicy(const CouchRetryPolicy &other)
+    : d_ptr(other.d_ptr)
+{
+}
+
+CouchRetryPolicy &CouchRetryPolicy::operator=(const CouchRetryPolicy &other)
+{
+    d_ptr.detach();
+    d_ptr = other.d_ptr;
+    return *this;
+}
+
+bool CouchRetryPolicy::operator==(const CouchRetryPolicy &other) const
+{
+    Q_D(const CouchRetryPolicy);
+    return d_ptr == other.d_ptr || (d->maxAttempts == other.maxAttempts() &&
+                                    d->baseDelay == other.baseDelay() &&
+                                    d->maxDelay == other.maxDelay() &&
+                                    d->statusCodes == other.statusCodes() &&
+                                    d->retryNetworkErrors == other.retryNetworkErrors());
+}
+
+bool CouchRetryPolicy::operator!=(const CouchRetryPolicy &other) const
+{
+    return !(*this == other);
+}
+
+int CouchRetryPolicy::maxAttempts() const
+{
+    Q_D(const CouchRetryPolicy);
+    return d->maxAttempts;
+}
+
+void CouchRetryPolicy::setMaxAttempts(int maxAttempts)
+{
+    maxAttempts = qMax(1, maxAttempts);
+    if (d_ptr->maxAttempts == maxAttempts)
+        return;
+
+    d_ptr.detach();
+    d_ptr->maxAttempts = maxAttempts;
+}
+
+int CouchRetryPolicy::baseDelay() const
+{
+    Q_D(const CouchRetryPolicy);
+    return d->baseDelay;
+}
+
+void CouchRetryPolicy::setBaseDelay(int baseDelay)
+{
+    baseDelay = qMax(0, baseDelay);
+    if (d_ptr->baseDelay == baseDelay)
+        return;
+
+    d_ptr.detach();
+    d_ptr->baseDelay = baseDelay;
+}
+
+int CouchRetryPolicy::maxDelay() const
+{
+    Q_D(const CouchRetryPolicy);
+    return d->maxDelay;
+}
+
+void CouchRetryPolicy::setMaxDelay(int maxDelay)
+{
+    maxDelay = qMax(0, maxDelay);
+    if (d_ptr->maxDelay == maxDelay)
+        return;
+
+    d_ptr.detach();
+    d_ptr->maxDelay = maxDelay;
+}
+
+QList<int> CouchRetryPolicy::statusCodes() const
+{
+    Q_D(const CouchRetryPolicy);
+    return d->statusCodes;
+}
+
+void CouchRetryPolicy::setStatusCodes(const QList<int> &statusCodes)
+{
+    if (d_ptr->statusCodes == statusCodes)
+        return;
+
+    d_ptr.detach();
+    d_ptr->statusCodes = statusCodes;
+}
+
+bool CouchRetryPolicy::retryNetworkErrors() const
+{
+    Q_D(const CouchRetryPolicy);
+    return d->retryNetworkErrors;
+}
+
+void CouchRetryPolicy::setRetryNetworkErrors(bool retryNetworkErrors)
+{
+    if (d_ptr->retryNetworkErrors == retryNetworkErrors)
+        return;
+
+    d_ptr.detach();
+    d_ptr->retryNetworkErrors = retryNetworkErrors;
+}
+
+int CouchRetryPolicy::delay(int attempt) const
+{
+    Q_D(const CouchRetryPolicy);
+    if (attempt < 1 || d->maxDelay <= 0)
+        return 0;
+
+    // full jitter: a random delay between zero and the capped exponential backoff
+    qint64 backoff = qint64(d->baseDelay) << qMin(attempt - 1, 30);
+    int cap = int(qMin<qint64>(backoff, d->maxDelay));
+    return QRandomGenerator::global()->bounded(cap + 1);
+}
+
+CouchRetryPolicy CouchRetryPolicy::exponential(int maxAttempts, int baseDelay, int maxDelay)
+{
+    CouchRetryPolicy policy;
+    policy.setMaxAttempts(maxAttempts);
+    policy.setBaseDelay(baseDelay);
+    policy.setMaxDelay(maxDelay);
+    return policy;
+}
+
+QDebug operator<<(QDebug debug, const CouchRetryPolicy &policy)
+{
+    QDebugStateSaver saver(debug);
+    debug.nospace().noquote() << "CouchRetryPolicy(max_attempts=" << policy.maxAttempts()
+                              << ", base_delay=" << policy.baseDelay()
+                              << ", max_delay=" << policy.maxDelay()
+                              << ", status_codes=" << policy.statusCodes()
+                              << ", network_errors=" << policy.retryNetworkErrors() << ')';
+    return debug;
+}
@@ -0,0 +1,59 @@
+#ifndef COUCHRETRYPOLICY_H
+#define COUCHRETRYPOLICY_H
+
+#include <QtCouchDB/couchglobal.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobjectdefs.h>
+#include <QtCore/qshareddata.h>
+
+class CouchRetryPolicyPrivate;
+
+class COUCHDB_EXPORT CouchRetryPolicy
+{
+    Q_GADGET
+    Q_PROPERTY(int maxAttempts READ maxAttempts WRITE setMaxAttempts)
+    Q_PROPERTY(int baseDelay READ baseDelay WRITE setBaseDelay)
+    Q_PROPERTY(int maxDelay READ maxDelay WRITE setMaxDelay)
+    Q_PROPERTY(QList<int> statusCodes READ statusCodes WRITE setStatusCodes)
+    Q_PROPERTY(bool retryNetworkErrors READ retryNetworkErrors WRITE setRetryNetworkErrors)
+
+public:
+    CouchRetryPolicy();
+    ~CouchRetryPolicy();
+
+    CouchRetryPolicy(const CouchRetryPolicy &other);
+    CouchRetryPolicy &operator=(const CouchRetryPolicy &other);
+
+    bool operator==(const CouchRetryPolicy &other) const;
+    bool operator!=(const CouchRetryPolicy &other) const;
+
+    int maxAttempts() const;
+    void setMaxAttempts(int maxAttempts);
+
+    int baseDelay() const;
+    void setBaseDelay(int baseDelay);
+
+    int maxDelay() const;
+    void setMaxDelay(int maxDelay);
+
+    QList<int> statusCodes() const;
+    void setStatusCodes(const QList<int> &statusCodes);
+
+    bool retryNetworkErrors() const;
+    void setRetryNetworkErrors(bool retryNetworkErrors);
+
+    int delay(int attempt) const;
+
+    static CouchRetryPolicy exponential(int maxAttempts, int baseDelay = 100, int maxDelay = 10000);
+
+private:
+    Q_DECLARE_PRIVATE(CouchRetryPolicy)
+    QExplicitlySharedDataPointer<CouchRetryPolicyPrivate> d_ptr;
+};
+
+COUCHDB_EXPORT QDebug operator<<(QDebug debug, const CouchRetryPolicy &policy);
+
+Q_DECLARE_METATYPE(CouchRetryPolicy)
+
+#endif // COUCHRETRYPOLICY_H
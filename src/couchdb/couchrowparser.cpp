@@ -0,0 +1,127 @@
+#include "couchrowparser_p.h"
+#include "couchdocument_p.h"
+#include "couchjson_p.h"
+
+void CouchRowParser::append(const QByteArray &data)
+{
+    m_buffer += data;
+    parse();
+}
+
+int CouchRowParser::rowCount() const
+{
+    return m_rows.count();
+}
+
+QList<CouchDocument> CouchRowParser::takeRows(int count)
+{
+    QList<CouchDocument> rows;
+    if (count < 0 || count >= m_rows.count()) {
+        rows.swap(m_rows);
+    } else {
+        rows = m_rows.mid(0, count);
+        m_rows.erase(m_rows.begin(), m_rows.begin() + count);
+    }
+    return rows;
+}
+
+QByteArray CouchRowParser::envelope() const
+{
+    return m_envelope;
+}
+
+void CouchRowParser::parse()
+{
+    const char *data = m_buffer.constData();
+    const int size = m_buffer.size();
+
+    // a backslash at the end of the previous data escapes the first new byte
+    if (m_escaped && m_pos < size) {
+        m_escaped = false;
+        ++m_pos;
+    }
+
+    // only the structural characters matter, the scanner skips all others
+    CouchJsonScanner scanner(data, m_pos, size);
+    for (m_pos = scanner.next(); m_pos != -1; m_pos = scanner.next()) {
+        const char c = data[m_pos];
+        if (m_inString) {
+            if (c == '\\') {
+                if (m_pos + 1 < size)
+                    scanner.skip(m_pos + 1);
+                else
+                    m_escaped = true;
+            } else if (c == '"') {
+                m_inString = false;
+                if (!m_inRows && m_depth == 1)
+                    m_string = m_buffer.mid(m_stringStart, m_pos - m_stringStart);
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            m_inString = true;
+            m_stringStart = m_pos + 1;
+            break;
+        case ':':
+            if (!m_inRows && m_depth == 1)
+                m_key = m_string;
+            break;
+        case ',':
+            if (!m_inRows && m_depth == 1)
+                m_key.clear();
+            break;
+        case '{':
+        case '[':
+            ++m_depth;
+            if (!m_inRows && m_depth == 2 && c == '[' && m_key == "rows") {
+                m_inRows = true;
+                flushEnvelope(m_pos + 1);
+            } else if (m_inRows && m_depth == 3) {
+                m_rowStart = m_pos;
+            }
+            break;
+        case '}':
+        case ']':
+            if (m_inRows && m_depth == 3 && m_rowStart != -1) {
+                m_rows += CouchDocumentPrivate::fromRow(m_buffer, m_rowStart, m_pos - m_rowStart + 1);
+                m_rowStart = -1;
+            }
+            --m_depth;
+            if (m_inRows && m_depth == 1) {
+                m_inRows = false;
+                m_envelopeStart = m_pos;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    m_pos = size;
+
+    if (!m_inRows)
+        flushEnvelope(size);
+
+    // only keep the bytes of an incomplete row or envelope key
+    int keep = size;
+    if (m_inRows && m_rowStart != -1)
+        keep = m_rowStart;
+    else if (!m_inRows && m_inString && m_depth == 1)
+        keep = m_stringStart;
+
+    if (keep > 0) {
+        m_buffer.remove(0, keep);
+        m_pos -= keep;
+        m_rowStart = m_rowStart != -1 ? m_rowStart - keep : -1;
+        m_stringStart -= keep;
+        m_envelopeStart = qMax(0, m_envelopeStart - keep);
+    }
+}
+
+void CouchRowParser::flushEnvelope(int end)
+{
+    if (end > m_envelopeStart)
+        m_envelope.append(m_buffer.constData() + m_envelopeStart, end - m_envelopeStart);
+    m_envelopeStart = end;
+}
@@ -0,0 +1,37 @@
+#ifndef COUCHROWPARSER_P_H
+#define COUCHROWPARSER_P_H
+
+#include <QtCouchDB/couchdocument.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
+
+class COUCHDB_EXPORT CouchRowParser
+{
+public:
+    void append(const QByteArray &data);
+
+    int rowCount() const;
+    QList<CouchDocument> takeRows(int count = -1);
+
+    QByteArray envelope() const;
+
+private:
+    void parse();
+    void flushEnvelope(int end);
+
+    QByteArray m_buffer;
+    QByteArray m_envelope;
+    QByteArray m_string;
+    QByteArray m_key;
+    QList<CouchDocument> m_rows;
+    int m_pos = 0;
+    int m_depth = 0;
+    int m_rowStart = -1;
+    int m_stringStart = -1;
+    int m_envelopeStart = 0;
+    bool m_inRows = false;
+    bool m_inString = false;
+    bool m_escaped = false;
+};
+
+#endif // COUCHROWPARSER_P_H
@@ -0,0 +1,259 @@
+#include "couchrowset.h"
+#include "couchdecoder_p.h"
+#include "couchdocument_p.h"
+#include "couchjson_p.h"
+
+#include <QtCore/qvector.h>
+
+struct CouchRowSpans
+{
+    CouchJsonSpan row;
+    CouchJsonSpan id;
+    CouchJsonSpan revision;
+    CouchJsonSpan key;
+    CouchJsonSpan value;
+    CouchJsonSpan doc;
+};
+
+// the response itself is the only copy of the data, the rows are offsets into it
+class CouchRowSetPrivate : public QSharedData
+{
+public:
+    // a copy that the caller can keep after the row set is gone
+    QByteArray slice(int index, CouchJsonSpan CouchRowSpans::*member) const
+    {
+        const CouchJsonSpan &span = rows.at(index).*member;
+        if (!span.isValid())
+            return QByteArray();
+        return QByteArray(source.constData() + span.start, span.length);
+    }
+
+    // no copy, only valid while the source is alive
+    QByteArray view(int index, CouchJsonSpan CouchRowSpans::*member) const
+    {
+        const CouchJsonSpan &span = rows.at(index).*member;
+        if (!span.isValid())
+            return QByteArray();
+        return QByteArray::fromRawData(source.constData() + span.start, span.length);
+    }
+
+    QString string(int index, CouchJsonSpan CouchRowSpans::*member) const
+    {
+        return CouchJson::toString(source, rows.at(index).*member);
+    }
+
+    CouchDocument document(int index) const
+    {
+        const CouchRowSpans &spans = rows.at(index);
+        return CouchDocumentPrivate::fromRow(source, spans.row, spans.id, spans.revision);
+    }
+
+    QByteArray source;
+    QVector<CouchRowSpans> rows;
+    int totalRows = 0;
+    int offset = 0;
+};
+
+CouchRowSet::CouchRowSet()
+    : d_ptr(new CouchRowSetPrivate)
+{
+}
+
+CouchRowSet::~CouchRowSet()
+{
+}
+
+CouchRowSet::CouchRowSet(const CouchRowSet &other)
+    : d_ptr(other.d_ptr)
+{
+}
+
+CouchRowSet &CouchRowSet::operator=(const CouchRowSet &other)
+{
+    d_ptr = other.d_ptr;
+    return *this;
+}
+
+bool CouchRowSet::operator==(const CouchRowSet &other) const
+{
+    Q_D(const CouchRowSet);
+    const CouchRowSetPrivate *o = other.d_func();
+    if (d == o)
+        return true;
+    if (count() != other.count() || totalRows() != other.totalRows() || offset() != other.offset())
+        return false;
+    for (int i = 0; i < count(); ++i) {
+        if (id(i) != other.id(i) || revision(i) != other.revision(i) ||
+            d->view(i, &CouchRowSpans::key) != o->view(i, &CouchRowSpans::key) ||
+            d->view(i, &CouchRowSpans::value) != o->view(i, &CouchRowSpans::value) ||
+            d->view(i, &CouchRowSpans::doc) != o->view(i, &CouchRowSpans::doc))
+            return false;
+    }
+    return true;
+}
+
+bool CouchRowSet::operator!=(const CouchRowSet &other) const
+{
+    return !(*this == other);
+}
+
+bool CouchRowSet::isEmpty() const
+{
+    Q_D(const CouchRowSet);
+    return d->rows.isEmpty();
+}
+
+int CouchRowSet::count() const
+{
+    Q_D(const CouchRowSet);
+    return d->rows.count();
+}
+
+int CouchRowSet::totalRows() const
+{
+    Q_D(const CouchRowSet);
+    return d->totalRows;
+}
+
+int CouchRowSet::offset() const
+{
+    Q_D(const CouchRowSet);
+    return d->offset;
+}
+
+CouchRowSet::Row CouchRowSet::at(int index) const
+{
+    Q_ASSERT_X(index >= 0 && index < count(), "CouchRowSet::at", "index out of range");
+    return Row(d_ptr.data(), index);
+}
+
+QString CouchRowSet::id(int index) const
+{
+    Q_D(const CouchRowSet);
+    return d->string(index, &CouchRowSpans::id);
+}
+
+QString CouchRowSet::revision(int index) const
+{
+    Q_D(const CouchRowSet);
+    return d->string(index, &CouchRowSpans::revision);
+}
+
+QByteArray CouchRowSet::key(int index) const
+{
+    Q_D(const CouchRowSet);
+    return d->slice(index, &CouchRowSpans::key);
+}
+
+QByteArray CouchRowSet::value(int index) const
+{
+    Q_D(const CouchRowSet);
+    return d->slice(index, &CouchRowSpans::value);
+}
+
+QByteArray CouchRowSet::doc(int index) const
+{
+    Q_D(const CouchRowSet);
+    return d->slice(index, &CouchRowSpans::doc);
+}
+
+CouchDocument CouchRowSet::document(int index) const
+{
+    Q_D(const CouchRowSet);
+    return d->document(index);
+}
+
+QList<CouchDocument> CouchRowSet::toDocumentList() const
+{
+    QList<CouchDocument> documents;
+    documents.reserve(count());
+    for (int i = 0; i < count(); ++i)
+        documents += document(i);
+    return documents;
+}
+
+CouchRowSet CouchRowSet::fromJson(const QByteArray &response)
+{
+    CouchRowSet rowSet;
+    CouchRowSetPrivate *d = rowSet.d_func();
+    d->source = response;
+
+    // the rows are counted first, so that the table is allocated once
+    const char *json = response.constData();
+    const QVector<CouchRowSpan> spans = CouchDecoder::rowSpans(response, [&](const QByteArray &key, const CouchJsonSpan &value) {
+        if (key == "total_rows")
+            d->totalRows = QByteArray::fromRawData(json + value.start, value.length).trimmed().toInt();
+        else if (key == "offset")
+            d->offset = QByteArray::fromRawData(json + value.start, value.length).trimmed().toInt();
+    });
+    d->rows.reserve(spans.count());
+    for (const CouchRowSpan &span : spans) {
+        // skips anything but objects, a truncated last row is not in the spans
+        if (json[span.start] != '{')
+            continue;
+        const CouchJsonSpan row(span.start, span.length);
+        const CouchJsonMembers members = CouchJson::members(json, row);
+        d->rows += CouchRowSpans{row, CouchJson::findId(json, members), CouchJson::findRevision(json, members),
+                                 members.key, members.value, members.doc};
+    }
+    return rowSet;
+}
+
+CouchRowSet::Row::Row(CouchRowSetPrivate *d, int index)
+    : d_ptr(d), m_index(index)
+{
+}
+
+CouchRowSet::Row::Row(const Row &other)
+    : d_ptr(other.d_ptr), m_index(other.m_index)
+{
+}
+
+CouchRowSet::Row::~Row()
+{
+}
+
+CouchRowSet::Row &CouchRowSet::Row::operator=(const Row &other)
+{
+    d_ptr = other.d_ptr;
+    m_index = other.m_index;
+    return *this;
+}
+
+QString CouchRowSet::Row::id() const
+{
+    return d_ptr->string(m_index, &CouchRowSpans::id);
+}
+
+QString CouchRowSet::Row::revision() const
+{
+    return d_ptr->string(m_index, &CouchRowSpans::revision);
+}
+
+QByteArray CouchRowSet::Row::key() const
+{
+    return d_ptr->slice(m_index, &CouchRowSpans::key);
+}
+
+QByteArray CouchRowSet::Row::value() const
+{
+    return d_ptr->slice(m_index, &CouchRowSpans::value);
+}
+
+QByteArray CouchRowSet::Row::doc() const
+{
+    return d_ptr->slice(m_index, &CouchRowSpans::doc);
+}
+
+CouchDocument CouchRowSet::Row::document() const
+{
+    return d_ptr->document(m_index);
+}
+
+QDebug operator<<(QDebug debug, const CouchRowSet &rowSet)
+{
+    QDebugStateSaver saver(debug);
+    debug.nospace() << "CouchRowSet(count=" << rowSet.count() << ", totalRows=" << rowSet.totalRows()
+                    << ", offset=" << rowSet.offset() << ')';
+    return debug;
+}
@@ -0,0 +1,133 @@
+#ifndef COUCHROWSET_H
+#define COUCHROWSET_H
+
+#include <QtCouchDB/couchglobal.h>
+#include <QtCouchDB/couchdocument.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobjectdefs.h>
+#include <QtCore/qshareddata.h>
+
+#include <iterator>
+
+class CouchRowSetPrivate;
+
+class COUCHDB_EXPORT CouchRowSet
+{
+    Q_GADGET
+    Q_PROPERTY(int count READ count)
+    Q_PROPERTY(int totalRows READ totalRows)
+    Q_PROPERTY(int offset READ offset)
+
+public:
+    // a row shares the data of its row set, and stays valid without it
+    class COUCHDB_EXPORT Row
+    {
+    public:
+        Row(const Row &other);
+        ~Row();
+        Row &operator=(const Row &other);
+
+        int index() const { return m_index; }
+
+        QString id() const;
+        QString revision() const;
+        QByteArray key() const;
+        QByteArray value() const;
+        QByteArray doc() const;
+        CouchDocument document() const;
+
+    private:
+        friend class CouchRowSet;
+        Row(CouchRowSetPrivate *d, int index);
+
+        QExplicitlySharedDataPointer<CouchRowSetPrivate> d_ptr;
+        int m_index;
+    };
+
+    // like the iterators of the Qt containers, only valid while the row set is alive
+
+    class const_iterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef int difference_type;
+        typedef Row value_type;
+        typedef const Row *pointer;
+        typedef Row reference;
+
+        const_iterator() : m_rowSet(nullptr), m_index(0) { }
+
+        Row operator*() const { return m_rowSet->at(m_index); }
+        Row operator[](int n) const { return m_rowSet->at(m_index + n); }
+
+        bool operator==(const const_iterator &other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator &other) const { return m_index != other.m_index; }
+        bool operator<(const const_iterator &other) const { return m_index < other.m_index; }
+
+        const_iterator &operator++() { ++m_index; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; ++m_index; return it; }
+        const_iterator &operator--() { --m_index; return *this; }
+        const_iterator operator--(int) { const_iterator it = *this; --m_index; return it; }
+        const_iterator &operator+=(int n) { m_index += n; return *this; }
+        const_iterator &operator-=(int n) { m_index -= n; return *this; }
+        const_iterator operator+(int n) const { return const_iterator(m_rowSet, m_index + n); }
+        const_iterator operator-(int n) const { return const_iterator(m_rowSet, m_index - n); }
+        int operator-(const const_iterator &other) const { return m_index - other.m_index; }
+
+    private:
+        friend class CouchRowSet;
+        const_iterator(const CouchRowSet *rowSet, int index) : m_rowSet(rowSet), m_index(index) { }
+
+        const CouchRowSet *m_rowSet;
+        int m_index;
+    };
+
+    CouchRowSet();
+    ~CouchRowSet();
+
+    CouchRowSet(const CouchRowSet &other);
+    CouchRowSet &operator=(const CouchRowSet &other);
+
+    bool operator==(const CouchRowSet &other) const;
+    bool operator!=(const CouchRowSet &other) const;
+
+    bool isEmpty() const;
+    int count() const;
+    int size() const { return count(); }
+
+    int totalRows() const;
+    int offset() const;
+
+    Row at(int index) const;
+    Row operator[](int index) const { return at(index); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    Q_INVOKABLE QString id(int index) const;
+    Q_INVOKABLE QString revision(int index) const;
+
+    // raw JSON, e.g. "\"foo\"" for a string key or "null" for a deleted doc
+    Q_INVOKABLE QByteArray key(int index) const;
+    Q_INVOKABLE QByteArray value(int index) const;
+    Q_INVOKABLE QByteArray doc(int index) const;
+
+    Q_INVOKABLE CouchDocument document(int index) const;
+    QList<CouchDocument> toDocumentList() const;
+
+    static CouchRowSet fromJson(const QByteArray &response);
+
+private:
+    Q_DECLARE_PRIVATE(CouchRowSet)
+    QExplicitlySharedDataPointer<CouchRowSetPrivate> d_ptr;
+};
+
+COUCHDB_EXPORT QDebug operator<<(QDebug debug, const CouchRowSet &rowSet);
+
+Q_DECLARE_METATYPE(CouchRowSet)
+
+#endif // COUCHROWSET_H
@@ -0,0 +1,92 @@
+#include "couchtrace_p.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+
+#include <chrono>
+
+void CouchTracer::setCapacity(int capacity)
+{
+    m_capacity = qMax(0, capacity);
+    clear();
+}
+
+void CouchTracer::clear()
+{
+    m_events.clear();
+    m_events.reserve(m_capacity);
+    m_lanes.clear();
+    m_next = 0;
+}
+
+int CouchTracer::lane(qint64 start, qint64 end)
+{
+    for (int i = 0; i < m_lanes.count(); ++i) {
+        if (m_lanes.at(i) <= start) {
+            m_lanes[i] = end;
+            return i;
+        }
+    }
+    m_lanes += end;
+    return m_lanes.count() - 1;
+}
+
+void CouchTracer::add(const CouchTraceEvent &event)
+{
+    if (m_capacity <= 0)
+        return;
+
+    if (m_events.count() < m_capacity) {
+        m_events += event;
+        return;
+    }
+
+    // overwrite the oldest event
+    m_events[m_next] = event;
+    m_next = (m_next + 1) % m_capacity;
+}
+
+QByteArray CouchTracer::toJson() const
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+    int lanes = 0;
+    for (int i = 0; i < m_events.count(); ++i) {
+        const CouchTraceEvent &event = m_events.at((m_next + i) % m_events.count());
+        QJsonObject json;
+        json.insert(QStringLiteral("name"), QString::fromUtf8(event.name));
+        json.insert(QStringLiteral("cat"), QStringLiteral("qtcouchdb"));
+        json.insert(QStringLiteral("ph"), QStringLiteral("X"));
+        json.insert(QStringLiteral("ts"), event.timestamp);
+        json.insert(QStringLiteral("dur"), event.duration);
+        json.insert(QStringLiteral("pid"), pid);
+        json.insert(QStringLiteral("tid"), event.lane);
+        if (!event.args.isEmpty())
+            json.insert(QStringLiteral("args"), event.args);
+        events.append(json);
+        lanes = qMax(lanes, event.lane + 1);
+    }
+
+    for (int lane = 0; lane < lanes; ++lane) {
+        QJsonObject json;
+        json.insert(QStringLiteral("name"), QStringLiteral("thread_name"));
+        json.insert(QStringLiteral("ph"), QStringLiteral("M"));
+        json.insert(QStringLiteral("pid"), pid);
+        json.insert(QStringLiteral("tid"), lane);
+        json.insert(QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), QStringLiteral("CouchClient %1").arg(lane)}});
+        events.append(json);
+    }
+
+    QJsonObject trace;
+    trace.insert(QStringLiteral("traceEvents"), events);
+    trace.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+qint64 CouchTracer::now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
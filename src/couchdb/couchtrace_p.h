@@ -0,0 +1,44 @@
+#ifndef COUCHTRACE_P_H
+#define COUCHTRACE_P_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qvector.h>
+
+struct CouchTraceEvent
+{
+    QByteArray name;
+    qint64 timestamp = 0;
+    qint64 duration = 0;
+    int lane = 0;
+    QJsonObject args;
+};
+
+// keeps the most recent events in a fixed size ring buffer, so that tracing
+// can stay enabled and the last moments before a hiccup can be exported
+class CouchTracer
+{
+public:
+    int capacity() const { return m_capacity; }
+    void setCapacity(int capacity);
+
+    bool isEnabled() const { return m_capacity > 0; }
+    void clear();
+
+    // assigns overlapping spans to separate lanes, which show up as threads
+    int lane(qint64 start, qint64 end);
+    void add(const CouchTraceEvent &event);
+
+    QByteArray toJson() const;
+
+    // microseconds on the steady clock, to line up with other traces
+    static qint64 now();
+
+private:
+    QVector<CouchTraceEvent> m_events;
+    QVector<qint64> m_lanes;
+    int m_next = 0;
+    int m_capacity = 0;
+};
+
+#endif // COUCHTRACE_P_H
@@ -27,6 +27,14 @@ public:
         return url;
     }
 
+    // for logs and traces, which must not leak the credentials
+    static QString masked(QUrl url)
+    {
+        if (!url.password().isEmpty())
+            url.setPassword(QStringLiteral("xxxxx"));
+        return url.toString();
+    }
+
 private:
     static QString join(const QString &basePath, const QString &subPath)
     {
@@ -1,9 +1,15 @@
 ﻿#include "couchview.h"
 #include "couchclient.h"
 #include "couchdatabase.h"
+#include "couchdecoder_p.h"
 #include "couchdesigndocument.h"
+#include "couchfuture_p.h"
 #include "couchrequest.h"
 #include "couchresponse.h"
+#include "couchresponse_p.h"
+
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qpointer.h>
 
 class CouchViewPrivate
 {
@@ -21,6 +27,7 @@ public:
 
     CouchView *q_ptr = nullptr;
     QString name;
+    int batchSize = 0;
     CouchDesignDocument *designDocument = nullptr;
 };
 
@@ -121,6 +128,23 @@ void CouchView::setDesignDocument(CouchDesignDocument *designDocument)
     emit designDocumentChanged(designDocument);
 }
 
+int CouchView::batchSize() const
+{
+    Q_D(const CouchView);
+    return d->batchSize;
+}
+
+void CouchView::setBatchSize(int batchSize)
+{
+    Q_D(CouchView);
+    batchSize = qMax(0, batchSize);
+    if (d->batchSize == batchSize)
+        return;
+
+    d->batchSize = batchSize;
+    emit batchSizeChanged(batchSize);
+}
+
 CouchResponse *CouchView::listRowIds()
 {
     return queryRows(CouchQuery());
@@ -131,6 +155,18 @@ CouchResponse *CouchView::listFullRows()
     return queryRows(CouchQuery::full());
 }
 
+QFuture<QList<CouchDocument>> CouchView::fetchRows(const CouchQuery &query)
+{
+    Q_D(CouchView);
+    CouchClient *client = d->designDocument ? d->designDocument->client() : nullptr;
+    QPointer<CouchView> view(this);
+    return CouchFuture::fetch<QList<CouchDocument>>(client, Couch::queryRows(url(), query), &Couch::toDocumentList,
+                                                    [=](const CouchError &error) {
+        if (view)
+            emit view->errorOccurred(error);
+    });
+}
+
 CouchResponse *CouchView::queryRows(const CouchQuery &query)
 {
     Q_D(CouchView);
@@ -143,8 +179,39 @@ CouchResponse *CouchView::queryRows(const CouchQuery &query)
     if (!response)
         return nullptr;
 
+    if (d->batchSize > 0) {
+        response->setBatchSize(d->batchSize);
+        connect(response, &CouchResponse::rowsReceived, this, &CouchView::rowsReceived);
+        return d->response(response);
+    }
+
+    int threshold = client->parallelDecodingThreshold();
     connect(response, &CouchResponse::received, [=](const QByteArray &data) {
-        emit rowsListed(Couch::toDocumentList(data));
+        // only decode the forms that are listened to
+        if (isSignalConnected(QMetaMethod::fromSignal(&CouchView::rowSetListed))) {
+            CouchRowSet rows = CouchRowSet::fromJson(data);
+            CouchResponsePrivate::get(response)->mark(CouchResponse::Parsed);
+            emit rowSetListed(rows);
+        }
+        if (!isSignalConnected(QMetaMethod::fromSignal(&CouchView::rowsListed)))
+            return;
+
+        if (threshold > 0 && data.size() >= threshold) {
+            // parsed and delivered once the rows are decoded
+            QPointer<CouchResponse> pointer(response);
+            CouchResponsePrivate::get(response)->deferDelivery();
+            CouchDecoder::decodeDocumentList(data, this, [=](const QList<CouchDocument> &rows) {
+                if (pointer)
+                    CouchResponsePrivate::get(pointer)->mark(CouchResponse::Parsed);
+                emit rowsListed(rows);
+                if (pointer)
+                    CouchResponsePrivate::completeDelivery(pointer);
+            });
+            return;
+        }
+        QList<CouchDocument> rows = Couch::toDocumentList(data);
+        CouchResponsePrivate::get(response)->mark(CouchResponse::Parsed);
+        emit rowsListed(rows);
     });
     return d->response(response);
 }
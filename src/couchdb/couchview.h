@@ -5,6 +5,7 @@
 #include <QtCouchDB/couch.h>
 #include <QtCouchDB/couchdocument.h>
 #include <QtCouchDB/coucherror.h>
+#include <QtCore/qfuture.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
 
@@ -21,6 +22,7 @@ class COUCHDB_EXPORT CouchView : public QObject
     Q_PROPERTY(QUrl url READ url NOTIFY urlChanged)
     Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
     Q_PROPERTY(CouchDesignDocument *designDocument READ designDocument WRITE setDesignDocument NOTIFY designDocumentChanged)
+    Q_PROPERTY(int batchSize READ batchSize WRITE setBatchSize NOTIFY batchSizeChanged)
 
 public:
     explicit CouchView(QObject *parent = nullptr);
@@ -37,6 +39,11 @@ public:
     CouchDesignDocument *designDocument() const;
     void setDesignDocument(CouchDesignDocument *designDocument);
 
+    int batchSize() const;
+    void setBatchSize(int batchSize);
+
+    QFuture<QList<CouchDocument>> fetchRows(const CouchQuery &query);
+
 public slots:
     CouchResponse *listRowIds();
     CouchResponse *listFullRows();
@@ -48,9 +55,12 @@ signals:
     void clientChanged(CouchClient *client);
     void databaseChanged(CouchDatabase *database);
     void designDocumentChanged(CouchDesignDocument *designDocument);
+    void batchSizeChanged(int batchSize);
     void errorOccurred(const CouchError &error);
 
     void rowsListed(const QList<CouchDocument> &rows);
+    void rowSetListed(const CouchRowSet &rows);
+    void rowsReceived(const QList<CouchDocument> &rows);
 
 private:
     Q_DECLARE_PRIVATE(CouchView)
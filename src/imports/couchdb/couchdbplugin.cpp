@@ -4,9 +4,11 @@
 #include <QtCouchDB/couchdesigndocument.h>
 #include <QtCouchDB/couchdocument.h>
 #include <QtCouchDB/coucherror.h>
+#include <QtCouchDB/couchmetrics.h>
 #include <QtCouchDB/couchquery.h>
 #include <QtCouchDB/couchrequest.h>
 #include <QtCouchDB/couchresponse.h>
+#include <QtCouchDB/couchretrypolicy.h>
 #include <QtCouchDB/couchview.h>
 #include <QtQml/qqml.h>
 #include <QtQml/qqmlengine.h>
@@ -25,8 +27,11 @@ void CouchDBPlugin::registerTypes(const char *uri)
 {
     qRegisterMetaType<CouchDocument>();
     qRegisterMetaType<CouchError>();
+    qRegisterMetaType<CouchMetrics>();
     qRegisterMetaType<CouchQuery>();
     qRegisterMetaType<CouchRequest>();
+    qRegisterMetaType<CouchRetryPolicy>();
+    qRegisterMetaType<CouchRowSet>();
 
     qmlRegisterSingletonType<Couch>(uri, 1, 0, "Couch", [](QQmlEngine *engine, QJSEngine *) -> QObject * {
         return new Couch(engine);
@@ -1,13 +1,18 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
+    await/tst_await.pro \
     client/tst_client.pro \
     database/tst_database.pro \
     designdocument/tst_designdocument.pro \
     document/tst_document.pro \
     error/tst_error.pro \
+    json/tst_json.pro \
+    metrics/tst_metrics.pro \
     qml/tst_qml.pro \
     query/tst_query.pro \
     request/tst_request.pro \
     response/tst_response.pro \
+    retrypolicy/tst_retrypolicy.pro \
+    rowset/tst_rowset.pro \
     view/tst_view.pro
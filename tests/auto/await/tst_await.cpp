@@ -0,0 +1,183 @@
+#include <QtTest>
+#include <QtCouchDB>
+
+#include "tst_shared.h"
+
+static const QByteArray TestDatabases = R"(["_replicator","_users","foo","bar"])";
+static const QByteArray TestDocument = R"({"_id":"doc1","_rev":"rev1","foo":"bar"})";
+
+#ifdef COUCHDB_HAS_COROUTINES
+struct TestTask
+{
+    struct promise_type
+    {
+        TestTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+#endif
+
+class tst_await : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void result();
+    void databases();
+    void document();
+    void error();
+    void invalid();
+    void delivered();
+};
+
+void tst_await::initTestCase()
+{
+    registerTestMetaTypes();
+}
+
+void tst_await::result()
+{
+    CouchResult<int> invalid;
+    QVERIFY(!invalid.isValid());
+    QVERIFY(!invalid);
+
+    CouchResult<int> value(123);
+    QVERIFY(value.isValid());
+    QCOMPARE(value.value(), 123);
+    QCOMPARE(*value, 123);
+
+    CouchResult<int> error(CouchError(404, "not_found", "missing"));
+    QVERIFY(!error.isValid());
+    QCOMPARE(error.error().code(), 404);
+    QCOMPARE(error.error().error(), "not_found");
+}
+
+#ifdef COUCHDB_HAS_COROUTINES
+static TestTask listDatabases(CouchClient *client, CouchResult<QStringList> *result, bool *done)
+{
+    *result = co_await CouchAwait::databases(client->listDatabases());
+    *done = true;
+}
+
+static TestTask getDocuments(CouchDatabase *database, QList<CouchResult<CouchDocument>> *results, bool *done)
+{
+    // dependent requests without nesting callbacks
+    CouchResult<CouchDocument> first = co_await CouchAwait::document(database->getDocument(CouchDocument("doc1")));
+    results->append(first);
+    if (first)
+        results->append(co_await CouchAwait::document(database->getDocument(*first)));
+    *done = true;
+}
+#endif
+
+void tst_await::databases()
+{
+#ifndef COUCHDB_HAS_COROUTINES
+    QSKIP("No coroutine support");
+#else
+    CouchClient client(TestUrl);
+
+    TestNetworkAccessManager manager(TestDatabases);
+    client.setNetworkAccessManager(&manager);
+
+    bool done = false;
+    CouchResult<QStringList> result;
+    listDatabases(&client, &result, &done);
+    QVERIFY(!done);
+
+    QTRY_VERIFY(done);
+    QVERIFY(result.isValid());
+    QCOMPARE(result.value(), QStringList({"_replicator","_users","foo","bar"}));
+#endif
+}
+
+void tst_await::document()
+{
+#ifndef COUCHDB_HAS_COROUTINES
+    QSKIP("No coroutine support");
+#else
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+
+    TestNetworkAccessManager manager(TestDocument);
+    client.setNetworkAccessManager(&manager);
+
+    bool done = false;
+    QList<CouchResult<CouchDocument>> results;
+    getDocuments(&database, &results, &done);
+
+    QTRY_VERIFY(done);
+    QCOMPARE(results.count(), 2);
+    QCOMPARE(results.at(0)->id(), "doc1");
+    QCOMPARE(results.at(1)->revision(), "rev1");
+    QCOMPARE(manager.urls.count(), 2);
+    QCOMPARE(manager.urls.last(), TestUrl.resolved(QUrl("/tst_database/doc1?rev=rev1")));
+#endif
+}
+
+void tst_await::error()
+{
+#ifndef COUCHDB_HAS_COROUTINES
+    QSKIP("No coroutine support");
+#else
+    CouchClient client(TestUrl);
+
+    TestNetworkAccessManager manager(QNetworkReply::UnknownServerError);
+    client.setNetworkAccessManager(&manager);
+
+    bool done = false;
+    CouchResult<QStringList> result;
+    listDatabases(&client, &result, &done);
+
+    QTRY_VERIFY(done);
+    QVERIFY(!result.isValid());
+    QCOMPARE(result.error().error(), "UnknownServerError");
+#endif
+}
+
+void tst_await::invalid()
+{
+#ifndef COUCHDB_HAS_COROUTINES
+    QSKIP("No coroutine support");
+#else
+    CouchDatabase database;
+
+    bool done = false;
+    QList<CouchResult<CouchDocument>> results;
+    getDocuments(&database, &results, &done);
+
+    QVERIFY(done);
+    QCOMPARE(results.count(), 1);
+    QVERIFY(!results.first().isValid());
+    QCOMPARE(results.first().error().error(), "InvalidRequest");
+#endif
+}
+
+void tst_await::delivered()
+{
+    CouchClient client(TestUrl);
+
+    TestNetworkAccessManager manager(TestDatabases);
+    client.setNetworkAccessManager(&manager);
+
+    // watching a response that has been delivered resumes with its data
+    QByteArray data;
+    bool watched = false;
+    CouchResponse *response = client.listDatabases();
+    connect(response, &CouchResponse::received, [&]() {
+        watched = CouchAwait::watch(response,
+                                    [&](const QByteArray &received) { data = received; },
+                                    [&](const CouchError &) { QFAIL("unexpected error"); });
+    });
+
+    QTRY_VERIFY(watched);
+    QTRY_COMPARE(data, TestDatabases);
+}
+
+QTEST_MAIN(tst_await)
+
+#include "tst_await.moc"
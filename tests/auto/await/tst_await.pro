@@ -0,0 +1,6 @@
+TARGET = tst_await
+CONFIG += testcase c++2a
+QT += core couchdb testlib
+SOURCES += tst_await.cpp
+
+include(../shared/tst_shared.pri)
@@ -27,10 +27,16 @@ private slots:
     void listDocuments();
     void queryDocuments_data();
     void queryDocuments();
+    void streamDocuments();
     void document_data();
     void document();
     void documents_data();
     void documents();
+    void deleteListedDocuments();
+    void fetchDocument();
+    void fetchDocuments();
+    void parallelDocuments();
+    void documentSet();
     void error();
 };
 
@@ -328,10 +334,14 @@ void tst_database::documents_data()
     QTest::addColumn<QNetworkAccessManager::Operation>("expectedOperation");
     QTest::addColumn<QUrl>("expectedUrl");
     QTest::addColumn<QString>("expectedSignal");
+    QTest::addColumn<QByteArray>("expectedBody");
 
-    QTest::newRow("insert") << "insertDocuments" << QNetworkAccessManager::PostOperation << TestUrl.resolved(QUrl("/tst_database")) << "documentsInserted(QList<CouchDocument>)";
-    QTest::newRow("update") << "updateDocuments" << QNetworkAccessManager::PostOperation << TestUrl.resolved(QUrl("/tst_database")) << "documentsUpdated(QList<CouchDocument>)";
-    QTest::newRow("delete") << "deleteDocuments" << QNetworkAccessManager::PostOperation << TestUrl.resolved(QUrl("/tst_database")) << "documentsDeleted(QList<CouchDocument>)";
+    const QByteArray docs = R"({"docs":[{"_id":"doc1","_rev":"rev1","foo":"bar"},{"_id":"doc2","_rev":"rev2","baz":"qux"}]})";
+    const QByteArray deletedDocs = R"({"docs":[{"_id":"doc1","_rev":"rev1","_deleted":true,"foo":"bar"},{"_id":"doc2","_rev":"rev2","_deleted":true,"baz":"qux"}]})";
+
+    QTest::newRow("insert") << "insertDocuments" << QNetworkAccessManager::PostOperation << TestUrl.resolved(QUrl("/tst_database")) << "documentsInserted(QList<CouchDocument>)" << docs;
+    QTest::newRow("update") << "updateDocuments" << QNetworkAccessManager::PostOperation << TestUrl.resolved(QUrl("/tst_database")) << "documentsUpdated(QList<CouchDocument>)" << docs;
+    QTest::newRow("delete") << "deleteDocuments" << QNetworkAccessManager::PostOperation << TestUrl.resolved(QUrl("/tst_database")) << "documentsDeleted(QList<CouchDocument>)" << deletedDocs;
 }
 
 void tst_database::documents()
@@ -340,6 +350,7 @@ void tst_database::documents()
     QFETCH(QNetworkAccessManager::Operation, expectedOperation);
     QFETCH(QUrl, expectedUrl);
     QFETCH(QString, expectedSignal);
+    QFETCH(QByteArray, expectedBody);
 
     CouchClient client(TestUrl);
     CouchDatabase database("tst_database", &client);
@@ -358,6 +369,7 @@ void tst_database::documents()
     QVERIFY(QMetaObject::invokeMethod(&database, method.toLatin1(), Q_ARG(QList<CouchDocument>, docs)));
     QCOMPARE(manager.operations, {expectedOperation});
     QCOMPARE(manager.urls, {expectedUrl});
+    QCOMPARE(manager.bodies, {expectedBody});
 
     QVERIFY(documentSpy.wait());
     QVariantList args = documentSpy.takeFirst();
@@ -365,6 +377,195 @@ void tst_database::documents()
     QCOMPARE(args.first().value<QList<CouchDocument>>(), docs);
 }
 
+void tst_database::deleteListedDocuments()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+
+    TestNetworkAccessManager manager(TestRows);
+    client.setNetworkAccessManager(&manager);
+
+    // listed documents are written flat, and marked deleted over their own _deleted
+    const QList<CouchDocument> docs = Couch::toDocumentList(R"({"rows":[
+        {"id":"doc1","key":"doc1","value":{"rev":"rev1"},"doc":{"_id":"doc1","_rev":"rev1","_deleted":false,"foo":"bar"}},
+        {"id":"doc2","key":"doc2","value":{"rev":"rev2"},"doc":{ "_id" : "doc2" , "_rev" : "rev2" , "baz" : [1, 2] }}
+    ]})");
+
+    QVERIFY(database.deleteDocuments(docs));
+    QCOMPARE(manager.bodies, {QByteArray(R"({"docs":[{"_id":"doc1","_rev":"rev1","_deleted":true,"foo":"bar"},{"_id":"doc2","_rev":"rev2","_deleted":true,"baz":[1, 2]}]})")});
+}
+
+void tst_database::streamDocuments()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+
+    QSignalSpy batchSizeSpy(&database, &CouchDatabase::batchSizeChanged);
+    QVERIFY(batchSizeSpy.isValid());
+
+    database.setBatchSize(2);
+    QCOMPARE(database.batchSize(), 2);
+    QCOMPARE(batchSizeSpy.count(), 1);
+
+    database.setBatchSize(2);
+    QCOMPARE(batchSizeSpy.count(), 1);
+
+    QSignalSpy rowSpy(&database, &CouchDatabase::rowsReceived);
+    QVERIFY(rowSpy.isValid());
+
+    QByteArray rows = R"({"total_rows":3,"offset":0,"rows":[)" + TestDocument1 + ",\n" + TestDocument2 + "," + TestDocument1 + "]}";
+    TestNetworkAccessManager manager(rows);
+    client.setNetworkAccessManager(&manager);
+
+    CouchResponse *response = database.listFullDocuments();
+    QVERIFY(response);
+
+    QSignalSpy receiveSpy(response, &CouchResponse::received);
+    QVERIFY(receiveSpy.isValid());
+
+    QVERIFY(receiveSpy.wait());
+    QCOMPARE(receiveSpy.first().first().toByteArray(), QByteArray(R"({"total_rows":3,"offset":0,"rows":[]})"));
+
+    CouchDocument doc1 = CouchDocument::fromJson(QJsonDocument::fromJson(TestDocument1).object());
+    CouchDocument doc2 = CouchDocument::fromJson(QJsonDocument::fromJson(TestDocument2).object());
+
+    QCOMPARE(rowSpy.count(), 2);
+    QCOMPARE(rowSpy.at(0).first().value<QList<CouchDocument>>(), QList<CouchDocument>({doc1, doc2}));
+    QCOMPARE(rowSpy.at(1).first().value<QList<CouchDocument>>(), {doc1});
+}
+
+void tst_database::fetchDocument()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+
+    TestNetworkAccessManager manager(TestDocument1);
+    client.setNetworkAccessManager(&manager);
+
+    CouchDocument doc = CouchDocument::fromJson(QJsonDocument::fromJson(TestDocument1).object());
+
+    QFuture<CouchDocument> future = database.fetchDocument(doc);
+    QVERIFY(future.isStarted());
+    QCOMPARE(manager.operations, {QNetworkAccessManager::GetOperation});
+    QCOMPARE(manager.urls, {TestUrl.resolved(QUrl("/tst_database/doc1?rev=rev1"))});
+
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(future.result(), doc);
+
+    CouchDatabase orphan("tst_database");
+    QFuture<CouchDocument> canceled = orphan.fetchDocument(doc);
+    QVERIFY(canceled.isFinished());
+    QVERIFY(canceled.isCanceled());
+}
+
+void tst_database::fetchDocuments()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+
+    TestNetworkAccessManager manager(TestRows);
+    client.setNetworkAccessManager(&manager);
+
+    QJsonObject doc1 = QJsonDocument::fromJson(TestDocument1).object();
+    QJsonObject doc2 = QJsonDocument::fromJson(TestDocument2).object();
+    QList<CouchDocument> expectedDocs = {CouchDocument::fromJson(doc1), CouchDocument::fromJson(doc2)};
+
+    QFuture<QList<CouchDocument>> future = database.fetchDocuments(CouchQuery::full());
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(future.result(), expectedDocs);
+
+    TestNetworkAccessManager failing(QNetworkReply::UnknownServerError);
+    client.setNetworkAccessManager(&failing);
+
+    QSignalSpy errorSpy(&database, &CouchDatabase::errorOccurred);
+    QVERIFY(errorSpy.isValid());
+
+    future = database.fetchDocuments(CouchQuery());
+    QVERIFY(errorSpy.wait());
+    QVERIFY(future.isFinished());
+    QVERIFY(future.isCanceled());
+}
+
+void tst_database::parallelDocuments()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+    QCOMPARE(client.parallelDecodingThreshold(), 0);
+
+    QSignalSpy thresholdSpy(&client, &CouchClient::parallelDecodingThresholdChanged);
+    QVERIFY(thresholdSpy.isValid());
+
+    client.setParallelDecodingThreshold(1);
+    QCOMPARE(client.parallelDecodingThreshold(), 1);
+    QCOMPARE(thresholdSpy.count(), 1);
+
+    // structural characters inside strings must not split the rows
+    QByteArray rows = R"({"total_rows":1000,"rows":[)";
+    for (int i = 0; i < 1000; ++i) {
+        if (i > 0)
+            rows += ",";
+        if (i % 3 == 0)
+            rows += R"({"id":"doc)" + QByteArray::number(i) + R"(","doc":{"text":"a \"}]\" b","list":[1,{"x":[]}]}})";
+        else
+            rows += i % 3 == 1 ? TestDocument1 : TestDocument2;
+    }
+    rows += "]}";
+
+    TestNetworkAccessManager manager(rows);
+    client.setNetworkAccessManager(&manager);
+
+    QSignalSpy listSpy(&database, &CouchDatabase::documentsListed);
+    QVERIFY(listSpy.isValid());
+
+    // the response is parsed and delivered once the rows are decoded
+    client.setAutoDeleteResponses(false);
+    CouchResponse *response = database.queryDocuments(CouchQuery::full());
+    QVERIFY(response);
+
+    qint64 parsed = -1;
+    qint64 delivered = -1;
+    connect(&database, &CouchDatabase::documentsListed, [&]() {
+        parsed = response->timestamp(CouchResponse::Parsed);
+        delivered = response->timestamp(CouchResponse::Delivered);
+    });
+    QVERIFY(listSpy.wait());
+    QVERIFY(parsed >= response->timestamp(CouchResponse::Finished));
+    QCOMPARE(delivered, -1);
+    QVERIFY(response->timestamp(CouchResponse::Delivered) >= parsed);
+
+    QList<CouchDocument> documents = listSpy.first().first().value<QList<CouchDocument>>();
+    QCOMPARE(documents.count(), 1000);
+    QCOMPARE(documents, Couch::toDocumentList(rows));
+    delete response;
+}
+
+void tst_database::documentSet()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+
+    const QByteArray rows = R"({"total_rows":3,"offset":1,"rows":[)" + TestDocument1 + "," + TestDocument2 + "]}";
+    TestNetworkAccessManager manager(rows);
+    client.setNetworkAccessManager(&manager);
+
+    QSignalSpy setSpy(&database, &CouchDatabase::documentSetListed);
+    QVERIFY(setSpy.isValid());
+    QSignalSpy listSpy(&database, &CouchDatabase::documentsListed);
+    QVERIFY(listSpy.isValid());
+
+    database.queryDocuments(CouchQuery::full());
+    QVERIFY(setSpy.wait());
+    QTRY_COMPARE(listSpy.count(), 1);
+
+    CouchRowSet documents = setSpy.first().first().value<CouchRowSet>();
+    QCOMPARE(documents.count(), 2);
+    QCOMPARE(documents.totalRows(), 3);
+    QCOMPARE(documents.offset(), 1);
+    QCOMPARE(documents.toDocumentList(), listSpy.first().first().value<QList<CouchDocument>>());
+}
+
 void tst_database::error()
 {
     CouchClient client(TestUrl);
@@ -9,6 +9,8 @@ private slots:
     void test();
     void json_data();
     void json();
+    void lazy_data();
+    void lazy();
     void debug();
 };
 
@@ -80,6 +82,53 @@ void tst_document::json()
     QCOMPARE(doc.toJson(), expectedJson);
 }
 
+void tst_document::lazy_data()
+{
+    QTest::addColumn<QByteArray>("row");
+
+    QTest::newRow("ids") << QByteArray(R"({"id":"id1","key":"id1","value":{"rev":"1-a"}})");
+    QTest::newRow("docs") << QByteArray(R"({"id":"id1","key":"id1","value":{"rev":"1-a"},"doc":{"_id":"id1","_rev":"1-a","foo":"bar"}})");
+    QTest::newRow("_id,_rev") << QByteArray(R"({"_id":"id1","_rev":"1-a","foo":"bar"})");
+    QTest::newRow("doc.id") << QByteArray(R"({"key":1,"doc":{"id":"id1","rev":"1-a","foo":[1,{"id":"x"}]}})");
+    QTest::newRow("deleted") << QByteArray(R"({"id":"id1","key":"id1","value":{"rev":"2-b","deleted":true},"doc":null})");
+    QTest::newRow("error") << QByteArray(R"({"key":"id1","error":"not_found"})");
+    QTest::newRow("whitespace") << QByteArray(" {\n  \"_id\" : \"id1\" ,\r\n\t\"_rev\":\"1-a\", \"n\" : -1.5e3 }\n");
+    QTest::newRow("escapes") << QByteArray(R"({"_id":"a\"b\\c\u00e4\n","_rev":"1-\/","s":"}{]["})");
+    QTest::newRow("utf-8") << QByteArray("{\"_id\":\"\xc3\xa4\xc3\xb6 \xe2\x82\xac\",\"_rev\":\"1-a\"}");
+    QTest::newRow("non-string") << QByteArray(R"({"_id":42,"id":"id1","_rev":null,"value":{"rev":"1-a"}})");
+}
+
+void tst_document::lazy()
+{
+    QFETCH(QByteArray, row);
+
+    const CouchDocument expected = CouchDocument::fromJson(QJsonDocument::fromJson(row).object());
+    const QList<CouchDocument> rows = Couch::toDocumentList(R"({"total_rows":1,"offset":0,"rows":[)" + row + "]}");
+    QCOMPARE(rows.count(), 1);
+
+    CouchDocument doc = rows.first();
+    QCOMPARE(doc.id(), expected.id());
+    QCOMPARE(doc.revision(), expected.revision());
+    QCOMPARE(doc.content(), expected.content());
+    QCOMPARE(doc.toJson(), expected.toJson());
+    QCOMPARE(doc, expected);
+
+    CouchDocument copy = doc.withRevision("2-b");
+    QCOMPARE(copy.id(), expected.id());
+    QCOMPARE(copy.revision(), "2-b");
+    QCOMPARE(copy.content(), expected.content());
+    QCOMPARE(doc.revision(), expected.revision());
+
+    copy = copy.withContent("content");
+    QCOMPARE(copy.content(), QByteArray("content"));
+    QCOMPARE(doc.content(), expected.content());
+
+    doc = "id2";
+    QCOMPARE(doc.id(), "id2");
+    QCOMPARE(doc.revision(), QString());
+    QCOMPARE(doc.content(), QByteArray());
+}
+
 void tst_document::debug()
 {
     QString str;
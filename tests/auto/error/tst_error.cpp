@@ -8,6 +8,7 @@ class tst_error : public QObject
 private slots:
     void test();
     void withCode();
+    void timeout();
     void debug();
 };
 
@@ -42,6 +43,13 @@ void tst_error::withCode()
     QCOMPARE(error.reason(), "reason");
 }
 
+void tst_error::timeout()
+{
+    QVERIFY(!CouchError().isTimeout());
+    QVERIFY(!CouchError("OperationCanceledError").isTimeout());
+    QVERIFY(CouchError("TimeoutError").isTimeout());
+}
+
 void tst_error::debug()
 {
     QString str;
@@ -0,0 +1,175 @@
+#include <QtTest>
+#include <QtCouchDB>
+#include <QtCouchDB/private/couchdecoder_p.h>
+#include <QtCouchDB/private/couchjson_p.h>
+#include <QtCouchDB/private/couchrowparser_p.h>
+
+class tst_json : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void mask();
+    void scanner();
+    void skipValue_data();
+    void skipValue();
+    void rows_data();
+    void rows();
+    void appendString_data();
+    void appendString();
+};
+
+void tst_json::mask()
+{
+    // every byte value at every position of a block
+    QByteArray bytes(320, Qt::Uninitialized);
+    for (int i = 0; i < bytes.size(); ++i)
+        bytes[i] = char(i * 7 % 256);
+
+    for (int offset = 0; offset + 64 <= bytes.size(); ++offset) {
+        for (int length : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64}) {
+            const char *json = bytes.constData() + offset;
+            QCOMPARE(CouchJsonScanner::mask(json, length), CouchJsonScanner::scalarMask(json, length));
+        }
+    }
+
+    QCOMPARE(CouchJsonScanner::scalarMask("a\"b\\c{d}e[f]g:h,i", 17), Q_UINT64_C(0xaaaa));
+}
+
+void tst_json::scanner()
+{
+    QByteArray json(200, 'x');
+    const QList<int> positions = {0, 1, 62, 63, 64, 65, 127, 128, 190, 199};
+    for (int pos : positions)
+        json[pos] = ",:{}[]\"\\,:"[positions.indexOf(pos)];
+
+    CouchJsonScanner scanner(json.constData(), 0, json.size());
+    QList<int> found;
+    for (int pos = scanner.next(); pos != -1; pos = scanner.next())
+        found += pos;
+    QCOMPARE(found, positions);
+
+    // the skipped position may be in the current or in the next block
+    CouchJsonScanner skipping(json.constData(), 0, json.size());
+    found.clear();
+    for (int pos = skipping.next(); pos != -1; pos = skipping.next()) {
+        found += pos;
+        if (pos == 0 || pos == 63 || pos == 127)
+            skipping.skip(pos + 1);
+    }
+    QCOMPARE(found, QList<int>({0, 62, 63, 65, 127, 190, 199}));
+
+    // a scan may start and end anywhere
+    CouchJsonScanner middle(json.constData(), 2, 128);
+    found.clear();
+    for (int pos = middle.next(); pos != -1; pos = middle.next())
+        found += pos;
+    QCOMPARE(found, QList<int>({62, 63, 64, 65, 127}));
+
+    CouchJsonScanner empty(json.constData(), 10, 10);
+    QCOMPARE(empty.next(), -1);
+}
+
+void tst_json::skipValue_data()
+{
+    QTest::addColumn<QByteArray>("value");
+
+    QTest::newRow("string") << QByteArray(R"("foo")");
+    QTest::newRow("escapes") << QByteArray(R"("a\"b\\"c\\\"d")").left(8);
+    QTest::newRow("object") << QByteArray(R"({"a":{"b":[1,2,{"c":"}"}]},"d":"]"})");
+    QTest::newRow("array") << QByteArray(R"([[],{},"[",["\""]])");
+    QTest::newRow("number") << QByteArray("-1.5e3");
+    QTest::newRow("literal") << QByteArray("true");
+}
+
+void tst_json::skipValue()
+{
+    QFETCH(QByteArray, value);
+
+    // at every alignment relative to the 64 byte blocks, and across them
+    for (int padding = 0; padding < 130; ++padding) {
+        QByteArray json = QByteArray(padding, ' ') + value + QByteArray(R"(,"x":"\"",)") + QByteArray(100, ' ') + '}';
+        QCOMPARE(CouchJson::skipValue(json.constData(), padding, json.size()), padding + value.size());
+    }
+
+    QByteArray longString = '"' + QByteArray(200, '\\') + '"';
+    QCOMPARE(CouchJson::skipValue(longString.constData(), 0, longString.size()), longString.size());
+    QByteArray truncated = R"({"a":"})";
+    QCOMPARE(CouchJson::skipValue(truncated.constData(), 0, truncated.size()), truncated.size());
+}
+
+void tst_json::rows_data()
+{
+    QTest::addColumn<int>("padding");
+
+    for (int padding : {0, 1, 31, 32, 63, 64, 65, 100})
+        QTest::addRow("%d", padding) << padding;
+}
+
+void tst_json::rows()
+{
+    QFETCH(int, padding);
+
+    // escapes and structural characters in strings, at shifting offsets
+    QByteArray json = R"({"total_rows":100,"pad":")" + QByteArray(padding, '.') + R"(","rows":[)";
+    for (int i = 0; i < 100; ++i) {
+        if (i > 0)
+            json += ",\n";
+        json += R"({"id":"doc)" + QByteArray::number(i) + R"(","key":"\\\"}]","value":{"rev":"1-)" + QByteArray::number(i) +
+                R"("},"doc":{"text":")" + QByteArray(i % 70, 'x') + R"(\"{[,:\\","list":[1,{"x":[]}]}})";
+    }
+    json += R"(],"tail":"]}"})";
+
+    const QJsonArray expected = QJsonDocument::fromJson(json).object().value("rows").toArray();
+    QCOMPARE(expected.count(), 100);
+
+    const QVector<CouchRowSpan> spans = CouchDecoder::rowSpans(json);
+    QCOMPARE(spans.count(), 100);
+    for (int i = 0; i < spans.count(); ++i) {
+        const QByteArray row = json.mid(spans.at(i).start, spans.at(i).length);
+        QCOMPARE(QJsonDocument::fromJson(row).object(), expected.at(i).toObject());
+    }
+
+    const QList<CouchDocument> documents = Couch::toDocumentList(json);
+    QCOMPARE(documents.count(), 100);
+    for (int i = 0; i < documents.count(); ++i)
+        QCOMPARE(documents.at(i), CouchDocument::fromJson(expected.at(i).toObject()));
+
+    // the same rows when streamed in pieces of every size up to a block
+    for (int chunk : {1, 2, 7, 63, 64, 65, 1000}) {
+        CouchRowParser parser;
+        for (int pos = 0; pos < json.size(); pos += chunk)
+            parser.append(json.mid(pos, chunk));
+        QCOMPARE(parser.takeRows(), documents);
+        QCOMPARE(QJsonDocument::fromJson(parser.envelope()).object().value("total_rows").toInt(), 100);
+    }
+}
+
+void tst_json::appendString_data()
+{
+    QTest::addColumn<QString>("string");
+
+    QTest::newRow("empty") << QString("");
+    QTest::newRow("plain") << QString("doc1");
+    QTest::newRow("quotes") << QString("\"a\\b\"");
+    QTest::newRow("control") << QString("a\nb\tc\rd\x01" "e\x1f");
+    QTest::newRow("unicode") << QString::fromUtf8("\xc3\xa4\xe2\x82\xac");
+}
+
+void tst_json::appendString()
+{
+    QFETCH(QString, string);
+
+    QByteArray json = "[";
+    CouchJson::appendString(json, string);
+    json += ']';
+
+    QJsonParseError error;
+    const QJsonArray array = QJsonDocument::fromJson(json, &error).array();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(array.at(0).toString(), string);
+}
+
+QTEST_MAIN(tst_json)
+
+#include "tst_json.moc"
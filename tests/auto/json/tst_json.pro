@@ -0,0 +1,4 @@
+TARGET = tst_json
+CONFIG += testcase
+QT += core couchdb-private testlib
+SOURCES += tst_json.cpp
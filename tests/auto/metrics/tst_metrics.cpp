@@ -0,0 +1,160 @@
+#include <QtTest>
+#include <QtCouchDB>
+
+#include "tst_shared.h"
+
+static const QByteArray TestDocument = R"({"_id":"doc1","_rev":"rev1","foo":"bar"})";
+
+class tst_metrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void endpoint_data();
+    void endpoint();
+    void requests();
+    void errors();
+    void latency();
+    void prometheus();
+};
+
+void tst_metrics::initTestCase()
+{
+    registerTestMetaTypes();
+}
+
+void tst_metrics::endpoint_data()
+{
+    QTest::addColumn<QUrl>("url");
+    QTest::addColumn<QUrl>("baseUrl");
+    QTest::addColumn<CouchMetrics::Endpoint>("endpoint");
+
+    QTest::newRow("all_dbs") << QUrl("http://localhost:5984/_all_dbs") << QUrl("http://localhost:5984") << CouchMetrics::ServerEndpoint;
+    QTest::newRow("database") << QUrl("http://localhost:5984/db") << QUrl("http://localhost:5984") << CouchMetrics::DatabaseEndpoint;
+    QTest::newRow("find") << QUrl("http://localhost:5984/db/_find") << QUrl("http://localhost:5984") << CouchMetrics::DatabaseEndpoint;
+    QTest::newRow("document") << QUrl("http://localhost:5984/db/doc") << QUrl("http://localhost:5984") << CouchMetrics::DocumentEndpoint;
+    QTest::newRow("design") << QUrl("http://localhost:5984/db/_design/foo") << QUrl("http://localhost:5984") << CouchMetrics::DocumentEndpoint;
+    QTest::newRow("all_docs") << QUrl("http://localhost:5984/db/_all_docs") << QUrl("http://localhost:5984") << CouchMetrics::AllDocsEndpoint;
+    QTest::newRow("bulk_docs") << QUrl("http://localhost:5984/db/_bulk_docs") << QUrl("http://localhost:5984") << CouchMetrics::BulkDocsEndpoint;
+    QTest::newRow("view") << QUrl("http://localhost:5984/db/_design/foo/_view/bar") << QUrl("http://localhost:5984") << CouchMetrics::ViewEndpoint;
+    QTest::newRow("prefix") << QUrl("http://localhost/couch/db/doc") << QUrl("http://localhost/couch/") << CouchMetrics::DocumentEndpoint;
+    QTest::newRow("root") << QUrl("http://localhost/couch/") << QUrl("http://localhost/couch/") << CouchMetrics::ServerEndpoint;
+}
+
+void tst_metrics::endpoint()
+{
+    QFETCH(QUrl, url);
+    QFETCH(QUrl, baseUrl);
+    QFETCH(CouchMetrics::Endpoint, endpoint);
+
+    QCOMPARE(CouchMetrics::endpoint(url, baseUrl), endpoint);
+}
+
+void tst_metrics::requests()
+{
+    CouchClient client(TestUrl);
+    QCOMPARE(client.metrics().requestCount(), 0);
+
+    TestNetworkAccessManager manager(TestDocument);
+    client.setNetworkAccessManager(&manager);
+
+    CouchDatabase database("db", &client);
+    QSignalSpy receiveSpy(&client, &CouchClient::responseReceived);
+    QVERIFY(receiveSpy.isValid());
+
+    CouchDocument document = CouchDocument("doc1").withContent(TestDocument);
+    database.getDocument(document);
+    database.updateDocument(document);
+    QTRY_COMPARE(receiveSpy.count(), 2);
+
+    CouchMetrics metrics = client.metrics();
+    QCOMPARE(metrics.requestCount(), 2);
+    QCOMPARE(metrics.requestCount(CouchRequest::Get, CouchMetrics::DocumentEndpoint), 1);
+    QCOMPARE(metrics.requestCount(CouchRequest::Post, CouchMetrics::DocumentEndpoint), 1);
+    QCOMPARE(metrics.errorCount(), 0);
+    QCOMPARE(metrics.bytesSent(CouchRequest::Get, CouchMetrics::DocumentEndpoint), 0);
+    QCOMPARE(metrics.bytesSent(CouchRequest::Post, CouchMetrics::DocumentEndpoint), qint64(TestDocument.size()));
+    QCOMPARE(metrics.bytesReceived(), qint64(2 * TestDocument.size()));
+
+    // a snapshot does not change with the client
+    database.getDocument(document);
+    QTRY_COMPARE(receiveSpy.count(), 3);
+    QCOMPARE(metrics.requestCount(), 2);
+    QCOMPARE(client.metrics().requestCount(), 3);
+
+    client.resetMetrics();
+    QCOMPARE(client.metrics().requestCount(), 0);
+    QCOMPARE(metrics.requestCount(), 2);
+}
+
+void tst_metrics::errors()
+{
+    CouchClient client(TestUrl);
+
+    TestNetworkAccessManager manager(QNetworkReply::ContentNotFoundError);
+    client.setNetworkAccessManager(&manager);
+
+    QSignalSpy errorSpy(&client, &CouchClient::errorOccurred);
+    QVERIFY(errorSpy.isValid());
+
+    client.deleteDatabase("db");
+    QVERIFY(errorSpy.wait());
+
+    CouchMetrics metrics = client.metrics();
+    QCOMPARE(metrics.requestCount(CouchRequest::Delete, CouchMetrics::DatabaseEndpoint), 1);
+    QCOMPARE(metrics.errorCount(CouchRequest::Delete, CouchMetrics::DatabaseEndpoint), 1);
+    QCOMPARE(metrics.errorCount(), 1);
+}
+
+void tst_metrics::latency()
+{
+    CouchClient client(TestUrl);
+
+    TestNetworkAccessManager manager;
+    manager.hang = true;
+    client.setNetworkAccessManager(&manager);
+
+    QSignalSpy errorSpy(&client, &CouchClient::errorOccurred);
+    QVERIFY(errorSpy.isValid());
+
+    CouchResponse *response = client.listDatabases();
+    QTest::qWait(20);
+    response->abort();
+    QTRY_COMPARE(errorSpy.count(), 1);
+
+    CouchMetrics metrics = client.metrics();
+    qint64 p50 = metrics.latency(CouchRequest::Get, CouchMetrics::ServerEndpoint, 0.5);
+    QVERIFY(p50 >= 19000);
+    QVERIFY(p50 <= metrics.latency(CouchRequest::Get, CouchMetrics::ServerEndpoint, 0.999));
+    QCOMPARE(metrics.latency(CouchRequest::Get, CouchMetrics::DocumentEndpoint, 0.5), 0);
+}
+
+void tst_metrics::prometheus()
+{
+    CouchClient client(TestUrl);
+
+    TestNetworkAccessManager manager(TestDocument);
+    client.setNetworkAccessManager(&manager);
+
+    QSignalSpy receiveSpy(&client, &CouchClient::responseReceived);
+    QVERIFY(receiveSpy.isValid());
+
+    client.listDatabases();
+    QVERIFY(receiveSpy.wait());
+
+    const QByteArray labels = R"({operation="get",endpoint="server")";
+    QByteArray text = client.metrics().toPrometheus();
+    QVERIFY(text.contains("# TYPE couchdb_client_requests_total counter\n"));
+    QVERIFY(text.contains("couchdb_client_requests_total" + labels + "} 1\n"));
+    QVERIFY(text.contains("couchdb_client_errors_total" + labels + "} 0\n"));
+    QVERIFY(text.contains("couchdb_client_received_bytes_total" + labels + "} " + QByteArray::number(TestDocument.size()) + "\n"));
+    QVERIFY(text.contains("# TYPE couchdb_client_request_duration_seconds summary\n"));
+    QVERIFY(text.contains("couchdb_client_request_duration_seconds" + labels + R"(,quantile="0.99"})"));
+    QVERIFY(text.contains("couchdb_client_request_duration_seconds_count" + labels + "} 1\n"));
+    QVERIFY(!text.contains(R"(endpoint="document")"));
+}
+
+QTEST_MAIN(tst_metrics)
+
+#include "tst_metrics.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_metrics
+CONFIG += testcase
+QT += core couchdb testlib
+SOURCES += tst_metrics.cpp
+
+include(../shared/tst_shared.pri)
@@ -18,18 +18,32 @@ void tst_request::test()
     QCOMPARE(r1.url(), QUrl());
     QCOMPARE(r1.operation(), CouchRequest::Get);
     QCOMPARE(r1.body(), QByteArray());
+    QCOMPARE(r1.priority(), CouchRequest::Normal);
+    QCOMPARE(r1.timeout(), -1);
+    QCOMPARE(r1.connectTimeout(), -1);
     QCOMPARE(r1.headers(), QByteArrayHash());
 
     CouchRequest r2(CouchRequest::Post);
     r2.setUrl(QUrl("foo:bar"));
     r2.setBody("foobar");
     r2.setHeader("foo", "bar");
+    r2.setPriority(CouchRequest::Bulk);
+    r2.setTimeout(1000);
+    r2.setConnectTimeout(100);
     QCOMPARE(r2.url(), QUrl("foo:bar"));
     QCOMPARE(r2.operation(), CouchRequest::Post);
     QCOMPARE(r2.body(), QByteArray("foobar"));
+    QCOMPARE(r2.priority(), CouchRequest::Bulk);
+    QCOMPARE(r2.timeout(), 1000);
+    QCOMPARE(r2.connectTimeout(), 100);
     QCOMPARE(r2.headers(), QByteArrayHash({{"foo", "bar"}}));
     QCOMPARE(r2.header("foo"), "bar");
 
+    CouchRequest r3(r2);
+    r3.setPriority(CouchRequest::Interactive);
+    QCOMPARE(r3.priority(), CouchRequest::Interactive);
+    QCOMPARE(r2.priority(), CouchRequest::Bulk);
+
     QVERIFY(r1 != r2);
     QVERIFY(r1 == CouchRequest(r1));
     QVERIFY(r2 == CouchRequest(r2));
@@ -0,0 +1,75 @@
+#include <QtTest>
+#include <QtCouchDB>
+
+class tst_retrypolicy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test();
+    void delay();
+    void debug();
+};
+
+void tst_retrypolicy::test()
+{
+    CouchRetryPolicy p1;
+    QCOMPARE(p1.maxAttempts(), 1);
+    QCOMPARE(p1.baseDelay(), 100);
+    QCOMPARE(p1.maxDelay(), 10000);
+    QCOMPARE(p1.statusCodes(), QList<int>({500, 502, 503, 504}));
+    QCOMPARE(p1.retryNetworkErrors(), true);
+
+    CouchRetryPolicy p2;
+    p2.setMaxAttempts(5);
+    p2.setBaseDelay(10);
+    p2.setMaxDelay(1000);
+    p2.setStatusCodes({503});
+    p2.setRetryNetworkErrors(false);
+    QCOMPARE(p2.maxAttempts(), 5);
+    QCOMPARE(p2.baseDelay(), 10);
+    QCOMPARE(p2.maxDelay(), 1000);
+    QCOMPARE(p2.statusCodes(), QList<int>({503}));
+    QCOMPARE(p2.retryNetworkErrors(), false);
+
+    QVERIFY(p1 != p2);
+    QVERIFY(p1 == CouchRetryPolicy(p1));
+    QVERIFY(p2 == CouchRetryPolicy(p2));
+
+    p1 = p2;
+    QCOMPARE(p1.maxAttempts(), 5);
+    QVERIFY(p1 == p2);
+
+    p2.setMaxAttempts(0);
+    QCOMPARE(p1.maxAttempts(), 5);
+    QCOMPARE(p2.maxAttempts(), 1);
+    QVERIFY(p1 != p2);
+
+    QCOMPARE(CouchRetryPolicy::exponential(3, 1, 2), CouchRetryPolicy::exponential(3, 1, 2));
+    QCOMPARE(CouchRetryPolicy::exponential(3, 1, 2).maxAttempts(), 3);
+}
+
+void tst_retrypolicy::delay()
+{
+    CouchRetryPolicy policy = CouchRetryPolicy::exponential(10, 100, 1000);
+    QCOMPARE(policy.delay(0), 0);
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(policy.delay(1) <= 100);
+        QVERIFY(policy.delay(2) <= 200);
+        QVERIFY(policy.delay(3) <= 400);
+        QVERIFY(policy.delay(9) <= 1000);
+        QVERIFY(policy.delay(100) <= 1000);
+        QVERIFY(policy.delay(100) >= 0);
+    }
+}
+
+void tst_retrypolicy::debug()
+{
+    QString str;
+    QDebug(&str) << CouchRetryPolicy::exponential(3, 1, 2);
+    QCOMPARE(str, "CouchRetryPolicy(max_attempts=3, base_delay=1, max_delay=2, status_codes=(500, 502, 503, 504), network_errors=true) ");
+}
+
+QTEST_MAIN(tst_retrypolicy)
+
+#include "tst_retrypolicy.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_retrypolicy
+CONFIG += testcase
+QT += core couchdb testlib
+SOURCES += tst_retrypolicy.cpp
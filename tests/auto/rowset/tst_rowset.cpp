@@ -0,0 +1,161 @@
+#include <QtTest>
+#include <QtCouchDB>
+
+static const QByteArray TestRows = R"({"total_rows":5,"offset":2,"rows":[
+{"id":"doc1","key":"doc1","value":{"rev":"1-a"},"doc":{"_id":"doc1","_rev":"1-a","foo":"bar"}},
+{"id":"doc2","key":["a",2],"value":3.5,"doc":null},
+{"key":{"k":"v"},"value":{"id":"doc3","rev":"2-b"}},
+{"id":"d\"o\\c\u00e44","key":null,"value":"}{]["}
+]})";
+
+class tst_rowset : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test();
+    void json();
+    void documents();
+    void iterate();
+    void invalid_data();
+    void invalid();
+    void debug();
+};
+
+void tst_rowset::test()
+{
+    CouchRowSet rows;
+    QVERIFY(rows.isEmpty());
+    QCOMPARE(rows.count(), 0);
+    QCOMPARE(rows.totalRows(), 0);
+    QCOMPARE(rows.offset(), 0);
+    QVERIFY(rows.begin() == rows.end());
+    QCOMPARE(rows.toDocumentList(), QList<CouchDocument>());
+
+    CouchRowSet other = Couch::toRowSet(TestRows);
+    QVERIFY(rows != other);
+    QVERIFY(other == CouchRowSet::fromJson(TestRows));
+
+    rows = other;
+    QVERIFY(rows == other);
+    QCOMPARE(rows.count(), 4);
+}
+
+void tst_rowset::json()
+{
+    CouchRowSet rows = CouchRowSet::fromJson(TestRows);
+    QVERIFY(!rows.isEmpty());
+    QCOMPARE(rows.count(), 4);
+    QCOMPARE(rows.size(), 4);
+    QCOMPARE(rows.totalRows(), 5);
+    QCOMPARE(rows.offset(), 2);
+
+    // the envelope may also follow the rows
+    CouchRowSet trailing = CouchRowSet::fromJson(R"({"rows":[{"id":"doc1"}], "total_rows" : 7 ,"offset":3})");
+    QCOMPARE(trailing.count(), 1);
+    QCOMPARE(trailing.totalRows(), 7);
+    QCOMPARE(trailing.offset(), 3);
+
+    QCOMPARE(rows.id(0), "doc1");
+    QCOMPARE(rows.revision(0), "1-a");
+    QCOMPARE(rows.key(0), R"("doc1")");
+    QCOMPARE(rows.value(0), R"({"rev":"1-a"})");
+    QCOMPARE(rows.doc(0), R"({"_id":"doc1","_rev":"1-a","foo":"bar"})");
+
+    QCOMPARE(rows.id(1), "doc2");
+    QCOMPARE(rows.revision(1), QString());
+    QCOMPARE(rows.key(1), R"(["a",2])");
+    QCOMPARE(rows.value(1), "3.5");
+    QCOMPARE(rows.doc(1), "null");
+
+    QCOMPARE(rows.id(2), "doc3");
+    QCOMPARE(rows.revision(2), "2-b");
+    QCOMPARE(rows.key(2), R"({"k":"v"})");
+    QCOMPARE(rows.doc(2), QByteArray());
+
+    QCOMPARE(rows.id(3), QString::fromUtf8("d\"o\\c\xc3\xa4" "4"));
+    QCOMPARE(rows.key(3), "null");
+    QCOMPARE(rows.value(3), R"("}{][")");
+}
+
+void tst_rowset::documents()
+{
+    CouchRowSet rows = Couch::toRowSet(TestRows);
+    QList<CouchDocument> expected = Couch::toDocumentList(TestRows);
+    QCOMPARE(expected.count(), rows.count());
+
+    for (int i = 0; i < rows.count(); ++i) {
+        QCOMPARE(rows.document(i), expected.at(i));
+        QCOMPARE(rows.document(i).id(), rows.id(i));
+        QCOMPARE(rows.document(i).revision(), rows.revision(i));
+    }
+    QCOMPARE(rows.toDocumentList(), expected);
+}
+
+void tst_rowset::iterate()
+{
+    CouchRowSet rows = Couch::toRowSet(TestRows);
+
+    QStringList ids;
+    for (const CouchRowSet::Row &row : rows) {
+        QCOMPARE(row.id(), rows.id(row.index()));
+        QCOMPARE(row.revision(), rows.revision(row.index()));
+        QCOMPARE(row.key(), rows.key(row.index()));
+        QCOMPARE(row.value(), rows.value(row.index()));
+        QCOMPARE(row.doc(), rows.doc(row.index()));
+        QCOMPARE(row.document(), rows.document(row.index()));
+        ids += row.id();
+    }
+    QCOMPARE(ids.count(), 4);
+    QCOMPARE(ids.mid(0, 3), QStringList({"doc1", "doc2", "doc3"}));
+
+    QCOMPARE(rows.end() - rows.begin(), 4);
+    QCOMPARE((*(rows.begin() + 2)).id(), "doc3");
+    QCOMPARE(rows[1].id(), "doc2");
+    QCOMPARE(rows.at(0).index(), 0);
+
+    // a row keeps the data of its row set alive
+    const CouchRowSet::Row row = Couch::toRowSet(TestRows).at(1);
+    QCOMPARE(row.id(), "doc2");
+    QCOMPARE(row.key(), R"(["a",2])");
+    QCOMPARE(row.document().id(), "doc2");
+
+    // the raw JSON outlives the row set it came from
+    QByteArray key = Couch::toRowSet(TestRows).key(1);
+    QCOMPARE(key, R"(["a",2])");
+}
+
+void tst_rowset::invalid_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("empty") << QByteArray() << 0;
+    QTest::newRow("garbage") << QByteArray("garbage") << 0;
+    QTest::newRow("array") << QByteArray(R"([{"id":"foo"}])") << 0;
+    QTest::newRow("no rows") << QByteArray(R"({"total_rows":0})") << 0;
+    QTest::newRow("non-objects") << QByteArray(R"({"rows":[1,"two",[3],{"id":"four"}]})") << 1;
+    QTest::newRow("truncated") << QByteArray(R"({"rows":[{"id":"one"},{"id":"tw)") << 1;
+}
+
+void tst_rowset::invalid()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(int, count);
+
+    CouchRowSet rows = CouchRowSet::fromJson(json);
+    QCOMPARE(rows.count(), count);
+    for (const CouchRowSet::Row &row : rows)
+        row.document().content();
+}
+
+void tst_rowset::debug()
+{
+    QString str;
+    QDebug(&str) << CouchRowSet::fromJson(TestRows);
+    QCOMPARE(str, "CouchRowSet(count=4, totalRows=5, offset=2) ");
+}
+
+QTEST_MAIN(tst_rowset)
+
+#include "tst_rowset.moc"
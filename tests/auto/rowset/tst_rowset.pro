@@ -0,0 +1,4 @@
+TARGET = tst_rowset
+CONFIG += testcase
+QT += core couchdb testlib
+SOURCES += tst_rowset.cpp
@@ -16,10 +16,14 @@ static inline void registerTestMetaTypes()
     qRegisterMetaType<CouchDesignDocument *>();
     qRegisterMetaType<CouchDocument>();
     qRegisterMetaType<CouchError>();
+    qRegisterMetaType<CouchMetrics>();
     qRegisterMetaType<CouchQuery>();
     qRegisterMetaType<CouchResponse *>();
     qRegisterMetaType<CouchRequest>();
     qRegisterMetaType<CouchRequest::Operation>();
+    qRegisterMetaType<CouchRequest::Priority>();
+    qRegisterMetaType<CouchRetryPolicy>();
+    qRegisterMetaType<CouchRowSet>();
     qRegisterMetaType<CouchView *>();
     qRegisterMetaType<QNetworkAccessManager::Operation>();
 }
@@ -36,7 +40,15 @@ public:
     }
 
 public slots:
-    void abort() override { }
+    void abort() override
+    {
+        if (!m_pending)
+            return;
+
+        m_pending = false;
+        setError(QNetworkReply::OperationCanceledError, "Operation canceled");
+        emit finished();
+    }
 
 protected:
     bool isSequential() const override { return m_buffer->isSequential(); }
@@ -55,6 +67,7 @@ protected:
 private:
     friend class TestNetworkAccessManager;
     QBuffer *m_buffer = nullptr;
+    bool m_pending = false;
 };
 
 class TestNetworkAccessManager : public QNetworkAccessManager
@@ -72,6 +85,12 @@ public:
     QList<QUrl> urls;
     QList<QByteArray> bodies;
     QHash<QByteArray, QByteArray> headers;
+    QHash<QByteArray, QByteArray> replyHeaders;
+    QHash<int, QVariant> replyAttributes;
+    bool hang = false;
+
+    void setData(const QByteArray &data) { m_data = data; }
+    void setError(QNetworkReply::NetworkError error) { m_error = error; }
 
 protected:
     QNetworkReply *createRequest(Operation operation, const QNetworkRequest &request, QIODevice *dev) override
@@ -85,8 +104,17 @@ protected:
         TestNetworkReply *reply = new TestNetworkReply(m_data, this);
         reply->setOperation(operation);
         reply->setRequest(request);
+        for (auto it = replyHeaders.cbegin(); it != replyHeaders.cend(); ++it)
+            reply->setRawHeader(it.key(), it.value());
+        for (auto it = replyAttributes.cbegin(); it != replyAttributes.cend(); ++it)
+            reply->setAttribute(static_cast<QNetworkRequest::Attribute>(it.key()), it.value());
         reply->setError(m_error, "");
         reply->open(QIODevice::ReadOnly);
+        if (hang) {
+            // never finishes unless aborted
+            reply->m_pending = true;
+            return reply;
+        }
         if (m_error != QNetworkReply::NoError)
             QMetaObject::invokeMethod(reply, "error", Qt::QueuedConnection, Q_ARG(QNetworkReply::NetworkError, m_error));
         else
@@ -20,6 +20,9 @@ private slots:
     void listRows();
     void queryRows_data();
     void queryRows();
+    void streamRows();
+    void rowSet();
+    void fetchRows();
     void error();
 };
 
@@ -271,6 +274,102 @@ void tst_view::queryRows()
     QCOMPARE(args.first().value<QList<CouchDocument>>(), expectedDocs);
 }
 
+void tst_view::streamRows()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+    CouchDesignDocument designDocument("tst_designdocument", &database);
+    CouchView view("tst_view", &designDocument);
+
+    QSignalSpy batchSizeSpy(&view, &CouchView::batchSizeChanged);
+    QVERIFY(batchSizeSpy.isValid());
+
+    view.setBatchSize(1);
+    QCOMPARE(view.batchSize(), 1);
+    QCOMPARE(batchSizeSpy.count(), 1);
+
+    QSignalSpy listSpy(&view, &CouchView::rowsListed);
+    QVERIFY(listSpy.isValid());
+
+    QSignalSpy rowSpy(&view, &CouchView::rowsReceived);
+    QVERIFY(rowSpy.isValid());
+
+    TestNetworkAccessManager manager(TestFullRows);
+    client.setNetworkAccessManager(&manager);
+
+    CouchResponse *response = view.listFullRows();
+    QVERIFY(response);
+    QCOMPARE(response->batchSize(), 1);
+
+    QSignalSpy receiveSpy(response, &CouchResponse::received);
+    QVERIFY(receiveSpy.isValid());
+
+    QVERIFY(receiveSpy.wait());
+    QCOMPARE(receiveSpy.first().first().toByteArray(), QByteArray(R"({"rows":[]})"));
+    QVERIFY(listSpy.isEmpty());
+
+    QJsonObject row1 = QJsonDocument::fromJson(R"({"id":"foo","doc":{"foo":"bar"}})").object();
+    QJsonObject row2 = QJsonDocument::fromJson(R"({"id":"bar","doc":{"baz":"qux"}})").object();
+
+    QCOMPARE(rowSpy.count(), 2);
+    QCOMPARE(rowSpy.at(0).first().value<QList<CouchDocument>>(), {CouchDocument::fromJson(row1)});
+    QCOMPARE(rowSpy.at(1).first().value<QList<CouchDocument>>(), {CouchDocument::fromJson(row2)});
+}
+
+void tst_view::rowSet()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+    CouchDesignDocument designDocument("tst_designdocument", &database);
+    CouchView view("tst_view", &designDocument);
+
+    TestNetworkAccessManager manager(TestFullRows);
+    client.setNetworkAccessManager(&manager);
+
+    // only the row set is listened to
+    QSignalSpy rowSetSpy(&view, &CouchView::rowSetListed);
+    QVERIFY(rowSetSpy.isValid());
+
+    QVERIFY(view.listFullRows());
+    QVERIFY(rowSetSpy.wait());
+
+    CouchRowSet rows = rowSetSpy.takeFirst().first().value<CouchRowSet>();
+    QCOMPARE(rows.count(), 2);
+    QCOMPARE(rows.id(0), "foo");
+    QCOMPARE(rows.doc(0), R"({"foo":"bar"})");
+    QCOMPARE(rows.id(1), "bar");
+    QCOMPARE(rows.doc(1), R"({"baz":"qux"})");
+    QCOMPARE(rows.toDocumentList(), Couch::toDocumentList(TestFullRows));
+
+    // both forms when both are listened to
+    QSignalSpy rowsSpy(&view, &CouchView::rowsListed);
+    QVERIFY(rowsSpy.isValid());
+
+    QVERIFY(view.listFullRows());
+    QVERIFY(rowsSpy.wait());
+    QCOMPARE(rowSetSpy.count(), 1);
+    QCOMPARE(rowsSpy.first().first().value<QList<CouchDocument>>(), rows.toDocumentList());
+}
+
+void tst_view::fetchRows()
+{
+    CouchClient client(TestUrl);
+    CouchDatabase database("tst_database", &client);
+    CouchDesignDocument designDocument("tst_designdocument", &database);
+    CouchView view("tst_view", &designDocument);
+
+    TestNetworkAccessManager manager(TestFullRows);
+    client.setNetworkAccessManager(&manager);
+
+    QFuture<QList<CouchDocument>> future = view.fetchRows(CouchQuery::full());
+    QCOMPARE(manager.operations, {QNetworkAccessManager::GetOperation});
+    QCOMPARE(manager.urls, {TestUrl.resolved(QUrl("/tst_database/_design/tst_designdocument/_view/tst_view?include_docs=true"))});
+
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(future.result(), Couch::toDocumentList(TestFullRows));
+}
+
 void tst_view::error()
 {
     CouchClient client(TestUrl);
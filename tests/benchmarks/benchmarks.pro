@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    client/tst_bench_client.pro \
+    couch/tst_bench_couch.pro \
+    document/tst_bench_document.pro \
+    url/tst_bench_url.pro
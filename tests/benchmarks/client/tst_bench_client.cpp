@@ -0,0 +1,155 @@
+#include <QtTest>
+#include <QtCouchDB>
+
+#include "bench_shared.h"
+#include "bench_server.h"
+
+class tst_bench_client : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void getDocument_data();
+    void getDocument();
+    void queryDocuments_data();
+    void queryDocuments();
+    void concurrentRequests_data();
+    void concurrentRequests();
+
+private:
+    bool waitForIdle(CouchClient *client, int timeout = 30000);
+
+    BenchServer server;
+};
+
+void tst_bench_client::initTestCase()
+{
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    server.addDatabase("small");
+    server.addDatabase("large");
+    for (int i = 0; i < 10000; ++i)
+        server.addDocument("small", QJsonDocument::fromJson(benchContent(i, 256)).object());
+    for (int i = 0; i < 1000; ++i)
+        server.addDocument("large", QJsonDocument::fromJson(benchContent(i, 8192)).object());
+    QCOMPARE(server.documentCount("small"), 10000);
+    QCOMPARE(server.documentCount("large"), 1000);
+}
+
+bool tst_bench_client::waitForIdle(CouchClient *client, int timeout)
+{
+    if (!client->isBusy())
+        return true;
+
+    QEventLoop loop;
+    connect(client, &CouchClient::busyChanged, &loop, [&](bool busy) { if (!busy) loop.quit(); });
+    QTimer::singleShot(timeout, &loop, &QEventLoop::quit);
+    loop.exec();
+    return !client->isBusy();
+}
+
+void tst_bench_client::getDocument_data()
+{
+    QTest::addColumn<QString>("database");
+    QTest::addColumn<int>("latency");
+
+    QTest::newRow("256B") << "small" << 0;
+    QTest::newRow("8kB") << "large" << 0;
+    QTest::newRow("256B, 5ms") << "small" << 5;
+}
+
+// sequential round trips, one request in flight at a time
+void tst_bench_client::getDocument()
+{
+    QFETCH(QString, database);
+    QFETCH(int, latency);
+
+    server.setLatency(latency);
+    CouchClient client(server.url());
+    CouchDatabase db(database, &client);
+
+    int received = 0;
+    connect(&db, &CouchDatabase::documentReceived, [&]() { ++received; });
+
+    int index = 0;
+    QBENCHMARK {
+        db.getDocument(CouchDocument("doc" + QString::number(index++ % 1000)));
+        QVERIFY(waitForIdle(&client));
+    }
+    QCOMPARE(received, index);
+}
+
+void tst_bench_client::queryDocuments_data()
+{
+    QTest::addColumn<QString>("database");
+    QTest::addColumn<int>("limit");
+
+    QTest::newRow("10 x 256B") << "small" << 10;
+    QTest::newRow("10000 x 256B") << "small" << 10000;
+    QTest::newRow("1000 x 8kB") << "large" << 1000;
+}
+
+void tst_bench_client::queryDocuments()
+{
+    QFETCH(QString, database);
+    QFETCH(int, limit);
+
+    server.setLatency(0);
+    CouchClient client(server.url());
+    CouchDatabase db(database, &client);
+
+    int count = 0;
+    connect(&db, &CouchDatabase::documentsListed, [&](const QList<CouchDocument> &documents) { count = documents.count(); });
+
+    CouchQuery query;
+    query.setLimit(limit);
+    query.setIncludeDocs(true);
+
+    QBENCHMARK {
+        db.queryDocuments(query);
+        QVERIFY(waitForIdle(&client));
+    }
+    QCOMPARE(count, limit);
+}
+
+void tst_bench_client::concurrentRequests_data()
+{
+    QTest::addColumn<int>("requests");
+    QTest::addColumn<int>("maxActiveRequests");
+    QTest::addColumn<bool>("threaded");
+
+    for (int maxActiveRequests : {1, 6}) {
+        QTest::addRow("1000 requests, %d active", maxActiveRequests) << 1000 << maxActiveRequests << false;
+        QTest::addRow("1000 requests, %d active, threaded", maxActiveRequests) << 1000 << maxActiveRequests << true;
+    }
+}
+
+// throughput with many requests queued at once, with 1ms of server latency
+// to model a round trip to a server on the local network
+void tst_bench_client::concurrentRequests()
+{
+    QFETCH(int, requests);
+    QFETCH(int, maxActiveRequests);
+    QFETCH(bool, threaded);
+
+    server.setLatency(1);
+    CouchClient client(server.url());
+    client.setMaxActiveRequests(maxActiveRequests);
+    client.setThreaded(threaded);
+    CouchDatabase db("small", &client);
+
+    QBENCHMARK {
+        for (int i = 0; i < requests; ++i)
+            db.getDocument(CouchDocument("doc" + QString::number(i)));
+        QVERIFY(waitForIdle(&client));
+    }
+
+    const CouchMetrics metrics = client.metrics();
+    QCOMPARE(metrics.errorCount(), 0);
+}
+
+QTEST_MAIN(tst_bench_client)
+
+#include "tst_bench_client.moc"
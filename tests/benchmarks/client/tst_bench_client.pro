@@ -0,0 +1,6 @@
+TARGET = tst_bench_client
+CONFIG += benchmark
+QT += core network couchdb testlib
+SOURCES += tst_bench_client.cpp
+
+include(../shared/bench_shared.pri)
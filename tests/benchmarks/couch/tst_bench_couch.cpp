@@ -0,0 +1,187 @@
+#include <QtTest>
+#include <QtCouchDB>
+#include <QtCouchDB/private/couchdecoder_p.h>
+#include <QtCouchDB/private/couchjson_p.h>
+
+#include "bench_shared.h"
+
+class tst_bench_couch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void domDocumentList_data();
+    void domDocumentList();
+    void toDocumentList_data();
+    void toDocumentList();
+    void toRowSet_data();
+    void toRowSet();
+    void rowSpans_data();
+    void rowSpans();
+    void structuralMask_data();
+    void structuralMask();
+    void toDatabaseList_data();
+    void toDatabaseList();
+    void insertDocuments_data();
+    void insertDocuments();
+};
+
+void tst_bench_couch::domDocumentList_data()
+{
+    addBenchRows();
+}
+
+// the baseline that toDocumentList() is measured against: a full DOM
+// of the response, then a document for each of its rows
+void tst_bench_couch::domDocumentList()
+{
+    QFETCH(int, count);
+    QFETCH(int, size);
+
+    const QByteArray rows = benchRows(count, size);
+    if (QJsonDocument::fromJson(rows).isNull())
+        QSKIP("The payload exceeds the size limit of QJsonDocument");
+
+    QList<CouchDocument> documents;
+    QBENCHMARK {
+        documents.clear();
+        const QJsonArray array = QJsonDocument::fromJson(rows).object().value(QStringLiteral("rows")).toArray();
+        for (const QJsonValue &row : array)
+            documents += CouchDocument::fromJson(row.toObject());
+    }
+    QCOMPARE(documents.count(), count);
+}
+
+void tst_bench_couch::toDocumentList_data()
+{
+    addBenchRows();
+}
+
+void tst_bench_couch::toDocumentList()
+{
+    QFETCH(int, count);
+    QFETCH(int, size);
+
+    const QByteArray rows = benchRows(count, size);
+
+    QList<CouchDocument> documents;
+    QBENCHMARK {
+        documents = Couch::toDocumentList(rows);
+    }
+    QCOMPARE(documents.count(), count);
+}
+
+void tst_bench_couch::toRowSet_data()
+{
+    addBenchRows();
+}
+
+void tst_bench_couch::toRowSet()
+{
+    QFETCH(int, count);
+    QFETCH(int, size);
+
+    const QByteArray rows = benchRows(count, size);
+
+    CouchRowSet rowSet;
+    QBENCHMARK {
+        rowSet = Couch::toRowSet(rows);
+    }
+    QCOMPARE(rowSet.count(), count);
+}
+
+void tst_bench_couch::rowSpans_data()
+{
+    addBenchRows();
+}
+
+void tst_bench_couch::rowSpans()
+{
+    QFETCH(int, count);
+    QFETCH(int, size);
+
+    const QByteArray rows = benchRows(count, size);
+
+    QVector<CouchRowSpan> spans;
+    QBENCHMARK {
+        spans = CouchDecoder::rowSpans(rows);
+    }
+    QCOMPARE(spans.count(), count);
+}
+
+void tst_bench_couch::structuralMask_data()
+{
+    QTest::addColumn<bool>("scalar");
+
+    QTest::newRow("scalar") << true;
+    QTest::newRow("simd") << false;
+}
+
+// the raw throughput of locating structural characters in 256MB
+void tst_bench_couch::structuralMask()
+{
+    QFETCH(bool, scalar);
+
+    const QByteArray rows = benchRows(700000, 256).left(256 * 1024 * 1024);
+    const char *json = rows.constData();
+    const int blocks = rows.size() / 64;
+
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        for (int i = 0; i < blocks; ++i) {
+            const quint64 mask = scalar ? CouchJsonScanner::scalarMask(json + i * 64, 64)
+                                        : CouchJsonScanner::mask(json + i * 64, 64);
+            count += qPopulationCount(mask);
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void tst_bench_couch::toDatabaseList_data()
+{
+    QTest::addColumn<int>("count");
+
+    for (int count : {10, 1000, 100000})
+        QTest::addRow("%d", count) << count;
+}
+
+void tst_bench_couch::toDatabaseList()
+{
+    QFETCH(int, count);
+
+    QByteArray databases = "[";
+    for (int i = 0; i < count; ++i)
+        databases += (i > 0 ? ",\"tenant-" : "\"tenant-") + QByteArray::number(i) + '"';
+    databases += ']';
+
+    QStringList list;
+    QBENCHMARK {
+        list = Couch::toDatabaseList(databases);
+    }
+    QCOMPARE(list.count(), count);
+}
+
+void tst_bench_couch::insertDocuments_data()
+{
+    addBenchRows();
+}
+
+void tst_bench_couch::insertDocuments()
+{
+    QFETCH(int, count);
+    QFETCH(int, size);
+
+    const QUrl url("http://localhost:5984/db/_bulk_docs");
+    const QList<CouchDocument> documents = benchDocuments(count, size);
+
+    CouchRequest request;
+    QBENCHMARK {
+        request = Couch::insertDocuments(url, documents);
+    }
+    QVERIFY(!request.body().isEmpty());
+}
+
+QTEST_MAIN(tst_bench_couch)
+
+#include "tst_bench_couch.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_bench_couch
+CONFIG += benchmark
+QT += core couchdb-private testlib
+SOURCES += tst_bench_couch.cpp
+
+include(../shared/bench_shared.pri)
@@ -0,0 +1,64 @@
+#include <QtTest>
+#include <QtCouchDB>
+
+#include "bench_shared.h"
+
+class tst_bench_document : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fromJson_data();
+    void fromJson();
+    void toJson_data();
+    void toJson();
+};
+
+static void addDocumentSizes()
+{
+    QTest::addColumn<int>("size");
+
+    for (int size : {256, 2048, 8192, 65536})
+        QTest::addRow("%dB", size) << size;
+}
+
+void tst_bench_document::fromJson_data()
+{
+    addDocumentSizes();
+}
+
+void tst_bench_document::fromJson()
+{
+    QFETCH(int, size);
+
+    // a row as found in a view or _all_docs result
+    const QJsonObject row = QJsonDocument::fromJson(benchRow(1, size)).object();
+
+    CouchDocument document;
+    QBENCHMARK {
+        document = CouchDocument::fromJson(row);
+    }
+    QCOMPARE(document.id(), QString("doc1"));
+}
+
+void tst_bench_document::toJson_data()
+{
+    addDocumentSizes();
+}
+
+void tst_bench_document::toJson()
+{
+    QFETCH(int, size);
+
+    const CouchDocument document = CouchDocument("doc1", "1-abc").withContent(benchContent(1, size));
+
+    QJsonObject json;
+    QBENCHMARK {
+        json = document.toJson();
+    }
+    QVERIFY(!json.isEmpty());
+}
+
+QTEST_MAIN(tst_bench_document)
+
+#include "tst_bench_document.moc"
@@ -0,0 +1,6 @@
+TARGET = tst_bench_document
+CONFIG += benchmark
+QT += core couchdb testlib
+SOURCES += tst_bench_document.cpp
+
+include(../shared/bench_shared.pri)
@@ -0,0 +1,68 @@
+#ifndef BENCH_SHARED_H
+#define BENCH_SHARED_H
+
+#include <QtCore>
+#include <QtTest>
+#include <QtCouchDB>
+
+// document bodies of roughly the given size in bytes, shaped like typical
+// application data: a few scalar fields, a small array and some free text
+static inline QByteArray benchContent(int index, int size)
+{
+    QByteArray id = "doc" + QByteArray::number(index);
+    QByteArray json = R"({"_id":")" + id + R"(","_rev":"1-)" + QByteArray::number(index * 7919 % 100000) +
+                      R"(","type":"item","index":)" + QByteArray::number(index) +
+                      R"(,"price":)" + QByteArray::number(index % 1000 / 10.0) +
+                      R"(,"active":)" + (index % 2 ? "true" : "false") +
+                      R"(,"tags":["alpha","beta","gamma"],"text":")";
+    int padding = qMax(0, size - json.size() - 2);
+    json.reserve(json.size() + padding + 2);
+    for (int i = 0; i < padding; ++i)
+        json += char('a' + (index + i) % 26);
+    json += "\"}";
+    return json;
+}
+
+static inline QByteArray benchRow(int index, int size)
+{
+    QByteArray id = "doc" + QByteArray::number(index);
+    return R"({"id":")" + id + R"(","key":")" + id + R"(","value":{"rev":"1-)" +
+           QByteArray::number(index * 7919 % 100000) + R"("},"doc":)" + benchContent(index, size) + '}';
+}
+
+// an _all_docs response with include_docs=true
+static inline QByteArray benchRows(int count, int size)
+{
+    QByteArray json = R"({"total_rows":)" + QByteArray::number(count) + R"(,"offset":0,"rows":[)";
+    json.reserve(count * (size + 96));
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            json += ",\n";
+        json += benchRow(i, size);
+    }
+    json += "]}";
+    return json;
+}
+
+static inline QList<CouchDocument> benchDocuments(int count, int size)
+{
+    QList<CouchDocument> documents;
+    documents.reserve(count);
+    for (int i = 0; i < count; ++i)
+        documents += CouchDocument("doc" + QString::number(i)).withContent(benchContent(i, size));
+    return documents;
+}
+
+static inline void addBenchRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("size");
+
+    // small documents scale to the largest result sets, large ones less so
+    for (int count : {10, 1000, 100000, 1000000})
+        QTest::addRow("%d x 256B", count) << count << 256;
+    for (int count : {10, 1000, 10000})
+        QTest::addRow("%d x 8kB", count) << count << 8192;
+}
+
+#endif // BENCH_SHARED_H
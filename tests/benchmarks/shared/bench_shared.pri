@@ -0,0 +1,8 @@
+QT += network
+
+DEPENDPATH += $$PWD
+INCLUDEPATH += $$PWD
+
+HEADERS += \
+    $$PWD/bench_server.h \
+    $$PWD/bench_shared.h
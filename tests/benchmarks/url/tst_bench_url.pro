@@ -0,0 +1,4 @@
+TARGET = tst_bench_url
+CONFIG += benchmark
+QT += core couchdb-private testlib
+SOURCES += tst_bench_url.cpp